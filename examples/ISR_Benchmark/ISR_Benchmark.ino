@@ -0,0 +1,254 @@
+/*! @file ISR_Benchmark.ino
+
+@section ISR_Benchmark_intro_section Description
+
+Benchmark for the smoothLED interrupt handlers, measuring CPU cycles per call
+
+The sketch sweeps from 1 to 32 LEDs (limited to the number of pins available on the board and to the
+number of LEDs that fit into RAM while leaving FREE_RAM Bytes unused) for each combination of
+HARDWARE_MODE/SOFTWARE_MODE and CIE_MODE/NO_CIE_MODE. For every configuration the "pwmISR()" and
+"faderISR()" handlers are called directly with interrupts disabled and TIMER1 running in normal mode
+without a prescaler, so the TCNT1 difference is the exact number of CPU cycles used. "pwmISR()" is
+measured over a complete 256 step PWM frame and "faderISR()" over 256 ticks of an active fade, which
+includes the ticks that "faderISR()" skips while no level change is due. Then the effects are
+measured on software PWM LEDs with an update rate of 1ms, so that "faderISR()" computes a new level
+for every LED in every tick, which is the largest cost an effect can have. The results are written
+to the serial port as CSV lines so that they can be captured and compared between library versions.
+The "template" lines repeat the software PWM fade measurements with "smoothLEDT" instances, whose
+output and PWM step are compiled for the type instead of testing the flags of every LED, so the
+difference to the "fade" lines of the same mode and curve is the saving. Hardware PWM is left out
+there, as most of the pins used have no PWM timer.
+The header line contains the flash and static RAM footprint of the build, taken from the linker
+symbols that mark the end of the program image and the size of the ".data" and ".bss" sections.
+These are the same figures that the linker prints with "-Wl,--print-memory-usage" (the flash figure
+is only correct on processors with up to 64kB of flash). Each line contains the RAM used by the LED
+instances of that configuration. To compare the footprint of the compile-time options, such as
+CIE_MODE_ACTIVE, the sketch is compiled once for each setting.
+
+@section ISR_Benchmark_license GNU General Public License v3.0
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU
+General Public License as published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version. This program is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details. You should have
+received a copy of the GNU General Public License along with this program.  If not, see
+<http://www.gnu.org/licenses/>.
+
+@section ISR_Benchmark_author Author
+
+Written by Arnd <Arnd@Zanduino.Com> at https://www.github.com/SV-Zanshin
+
+@section ISR_Benchmark_versions Changelog
+
+| Version| Date       | Developer  | Comments                                                      |
+| ------ | ---------- | ---------- | ------------------------------------------------------------- |
+| 1.1.0  | 2026-10-18 | SV-Zanshin | Initial coding                                                |
+*/
+
+#include <new.h>        // Placement new to construct and destroy instances
+#include "SmoothLED.h"  // Include the library
+#ifndef __AVR__
+#error This library and program is designed for Atmel ATMega processors
+#endif
+#ifdef SMOOTHLED_MODERN_AVR
+#error This program measures with TIMER1 and only runs on the classic ATMega processors
+#endif
+
+const uint8_t  FIRST_PIN{2};                            //!< First pin, 0 and 1 are used by Serial
+const uint8_t  PIN_LEDS{NUM_DIGITAL_PINS - FIRST_PIN};  //!< One LED on each remaining pin
+const uint16_t FREE_RAM{512};                           //!< Kept for stack, Serial and statics
+const uint8_t  LED_BYTES{sizeof(smoothLEDT<>)};         //!< Size of the larger LED class
+const uint8_t  RAM_LEDS{(RAMEND - RAMSTART + 1 - FREE_RAM) / LED_BYTES};  //!< LEDs fitting in RAM
+const uint8_t  MAX_LEDS{PIN_LEDS < RAM_LEDS ? (PIN_LEDS < 32 ? PIN_LEDS : 32)
+                                            : (RAM_LEDS < 32 ? RAM_LEDS : 32)};  //!< Largest count
+const uint32_t PWM_RATE{F_CPU / 1024UL};                //!< pwmISR() calls/second (TIMER1 10-bit)
+const uint32_t FADER_RATE{F_CPU / 16384UL};             //!< faderISR() calls/second (TIMER0)
+
+extern char __data_start;     //!< Linker symbol, start of the initialized data in RAM
+extern char __data_end;       //!< Linker symbol, end of the initialized data in RAM
+extern char __bss_start;      //!< Linker symbol, start of the zero-initialized data in RAM
+extern char __bss_end;        //!< Linker symbol, end of the zero-initialized data in RAM
+extern char __data_load_end;  //!< Linker symbol, end of the program image in flash
+
+alignas(smoothLED) uint8_t storage[MAX_LEDS][LED_BYTES];  //!< Raw storage of the LEDs
+
+/*! @brief Measurement results for one interrupt handler */
+struct cycleStats {
+  uint32_t total{0};  //!< Sum of all measured cycles
+  uint16_t worst{0};  //!< Largest single measurement
+};  // of struct "cycleStats"
+
+uint16_t measure(void (*handler)()) {
+  /*!
+      @brief    Measure the number of CPU cycles used by one call to a handler
+      @details  Interrupts are disabled by the caller and TIMER1 runs in normal mode at F_CPU
+      @param[in] handler Function to call
+      @return   uint16_t number of CPU cycles, including the constant overhead of the call
+  */
+  TCNT1 = 0;
+  handler();
+  return TCNT1;
+}  // of method "measure()"
+
+void emptyHandler() {
+  /*!
+      @brief    Empty function, used to measure the overhead of "measure()"
+  */
+}  // of method "emptyHandler()"
+
+void runHandler(void (*handler)(), cycleStats& stats, const uint16_t overhead) {
+  /*!
+      @brief    Call a handler 256 times and accumulate the cycle counts
+      @param[in]  handler  Function to call
+      @param[out] stats    Accumulated results
+      @param[in]  overhead Cycles used by "measure()" itself
+  */
+  for (uint16_t i = 0; i < 256; ++i) {
+    uint16_t cycles = measure(handler) - overhead;
+    stats.total += cycles;
+    if (cycles > stats.worst) stats.worst = cycles;
+  }  // for-next 256 calls
+}  // of method "runHandler()"
+
+bool startLED(smoothLED& led, const uint8_t pin, const uint8_t flags) {
+  /*!
+      @brief    Initialize a "smoothLED" instance
+      @param[in] led   LED to initialize
+      @param[in] pin   Arduino pin of the LED
+      @param[in] flags Flags passed to "begin()"
+      @return   bool TRUE on success
+  */
+  return led.begin(pin, flags);
+}  // of method "startLED()"
+
+template <bool Inverted, class CurvePolicy, class OutputPolicy>
+bool startLED(smoothLEDT<Inverted, CurvePolicy, OutputPolicy>& led, const uint8_t pin,
+              const uint8_t flags) {
+  /*!
+      @brief    Initialize a "smoothLEDT" instance, its flags are given by the template parameters
+      @param[in] led   LED to initialize
+      @param[in] pin   Arduino pin of the LED
+      @param[in] flags Unused, the equivalent flags are printed by "benchmark()"
+      @return   bool TRUE on success
+  */
+  return led.begin(pin);
+}  // of method "startLED()"
+
+template <class LED>
+void benchmark(const __FlashStringHelper* type, const uint8_t count, const uint8_t flags,
+               const uint8_t effect = EFFECT_NONE) {
+  /*!
+      @brief    Construct "count" LEDs with the given flags, measure both handlers and print a line
+      @tparam   LED     Class of the LEDs, "smoothLED" or a "smoothLEDT" type
+      @param[in] type   Name of the measurement or effect for the output
+      @param[in] count  Number of LEDs
+      @param[in] flags  Flags passed to "begin()"
+      @param[in] effect Effect to run on all LEDs instead of a fade, updated in every tick
+  */
+  LED* leds[MAX_LEDS];  // Pointers to the constructed instances
+  for (uint8_t i = 0; i < count; ++i) {
+    leds[i] = new (storage[i]) LED;  // construct in place, no heap used
+    startLED(*leds[i], FIRST_PIN + i, flags);
+    if (effect != EFFECT_NONE) {
+      leds[i]->setEffect(effect, 1, 253, 1);  // worst case, a new level in every tick
+    } else {
+      leds[i]->set(1);            // start just above "OFF" so that PWM is active
+      leds[i]->set(254, 60000U);  // and keep fading during the measurement
+    }                             // if-then-else effect
+  }                               // for-next each LED
+  delay(5);                     // let faderISR() start the fades
+  cycleStats pwm, fader;        // results
+  uint8_t    oldSREG = SREG;    // save interrupt state
+  cli();                        // no interrupts while measuring
+  uint8_t oldTCCR1A = TCCR1A;   // save TIMER1 setup
+  uint8_t oldTCCR1B = TCCR1B;
+  TCCR1A            = 0;          // normal mode,
+  TCCR1B            = _BV(CS10);  // no prescaler
+  uint16_t overhead = measure(emptyHandler);
+  runHandler(smoothLED::pwmISR, pwm, overhead);
+  runHandler(smoothLED::faderISR, fader, overhead);
+  TCCR1A = oldTCCR1A;  // restore TIMER1 setup
+  TCCR1B = oldTCCR1B;
+  SREG   = oldSREG;  // restore interrupts
+  for (uint8_t i = count; i > 0; --i) {
+    leds[i - 1]->~LED();  // destroy in reverse order of construction
+  }                       // for-next each LED
+  float pwmAvg   = pwm.total / 256.0;
+  float faderAvg = fader.total / 256.0;
+  float cpu      = (pwmAvg * PWM_RATE + faderAvg * FADER_RATE) * 100.0 / F_CPU;
+  Serial.print(type);
+  Serial.print(',');
+  Serial.print((flags & SOFTWARE_MODE) ? F("software,") : F("hardware,"));
+  Serial.print((flags & NO_CIE_MODE) ? F("no_cie,") : F("cie,"));
+  Serial.print(count);
+  Serial.print(',');
+  Serial.print(pwmAvg, 1);
+  Serial.print(',');
+  Serial.print(pwm.worst);
+  Serial.print(',');
+  Serial.print(faderAvg, 1);
+  Serial.print(',');
+  Serial.print(fader.worst);
+  Serial.print(',');
+  Serial.print(cpu, 2);
+  Serial.print(',');
+  Serial.print(sizeof(LED));
+  Serial.print(',');
+  Serial.println(sizeof(LED) * count);
+}  // of method "benchmark()"
+
+void setup() {
+  /*!
+      @brief    Arduino method called once at startup to initialize the system
+      @details  This is an Arduino IDE method which is called first upon boot or restart. It is only
+                called one time and then control goes to the main "loop()" method, from which
+                control never returns
+      @return   void
+  */
+  Serial.begin(115200);
+#ifdef __AVR_ATmega32U4__  // If a 32U4 processor, wait 3 seconds
+  delay(3000);
+#endif
+  const uint8_t modes[] = {HARDWARE_MODE | CIE_MODE, HARDWARE_MODE | NO_CIE_MODE,
+                           SOFTWARE_MODE | CIE_MODE, SOFTWARE_MODE | NO_CIE_MODE};
+  Serial.print(F("# F_CPU="));
+  Serial.print(F_CPU);
+  Serial.print(F(" pwm_hz="));
+  Serial.print(PWM_RATE);
+  Serial.print(F(" fader_hz="));
+  Serial.print(FADER_RATE);
+  Serial.print(F(" flash_bytes="));
+  Serial.print((uintptr_t)&__data_load_end);
+  Serial.print(F(" data_bytes="));
+  Serial.print(&__data_end - &__data_start);
+  Serial.print(F(" bss_bytes="));
+  Serial.println(&__bss_end - &__bss_start);
+  Serial.println(F("type,mode,curve,leds,pwm_avg,pwm_max,fader_avg,fader_max,cpu_pct,led_bytes,"
+                   "ram_bytes"));
+  for (uint8_t m = 0; m < sizeof(modes); ++m) {
+    for (uint8_t count = 1; count <= MAX_LEDS; ++count) {
+      benchmark<smoothLED>(F("fade"), count, modes[m]);
+    }  // for-next each LED count
+  }    // for-next each mode
+  for (uint8_t count = 1; count <= MAX_LEDS; ++count) {
+#ifdef CIE_MODE_ACTIVE
+    benchmark<smoothLEDT<false, cieCurve, softwarePWM>>(F("template"), count, modes[2]);
+#endif
+    benchmark<smoothLEDT<false, linearCurve, softwarePWM>>(F("template"), count, modes[3]);
+  }  // for-next each LED count
+  for (uint8_t count = 1; count <= MAX_LEDS; ++count) {
+    benchmark<smoothLED>(F("candle"), count, modes[2], EFFECT_CANDLE);
+    benchmark<smoothLED>(F("strobe"), count, modes[2], EFFECT_STROBE);
+    benchmark<smoothLED>(F("noise"), count, modes[2], EFFECT_NOISE);
+    benchmark<smoothLED>(F("heartbeat"), count, modes[2], EFFECT_HEARTBEAT);
+  }  // for-next each LED count
+  Serial.println(F("# done"));
+}  // of method "setup()"
+
+void loop() {
+  /*!
+      @brief    Arduino method for the main program loop
+      @details  Nothing to do, the benchmark runs once in "setup()"
+      @return   void
+  */
+}  // of method "loop()"
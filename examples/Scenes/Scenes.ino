@@ -0,0 +1,89 @@
+/*! @file Scenes.ino
+
+@section Scenes_intro_section Description
+
+Example for using the smoothLED library to crossfade a whole installation between stored scenes
+
+A scene is an array in program memory with one brightness level per LED, in the order in which the
+LEDs were defined. "smoothLED::crossfadeTo(scene, ms)" moves every LED from its current level to its
+level in the scene over the same time, so that all LEDs arrive together. Here the scenes are picked
+from a table of pointers, which don't carry the size of the arrays, so the number of levels is
+passed as well. This sketch drives a 3-color LED with a common cathode and cycles through a day,
+evening, night and off scene, holding each one for a few seconds.
+
+@section Scenes_license GNU General Public License v3.0
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU
+General Public License as published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version. This program is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details. You should have
+received a copy of the GNU General Public License along with this program.  If not, see
+<http://www.gnu.org/licenses/>.
+
+@section Scenes_author Author
+
+Written by Arnd <Arnd@Zanduino.Com> at https://www.github.com/SV-Zanshin
+
+@section Scenes_versions Changelog
+
+| Version| Date       | Developer  | Comments                                                      |
+| ------ | ---------- | ---------- | ------------------------------------------------------------- |
+| 1.1.0  | 2026-10-18 | SV-Zanshin | Initial coding                                                |
+*/
+
+#include "SmoothLED.h"  // Include the library
+#ifndef __AVR__
+#error This library and program is designed for Atmel ATMega processors
+#endif
+
+const uint8_t  RED_PIN{11};        //!< Red Pin number
+const uint8_t  GREEN_PIN{10};      //!< Green Pin number
+const uint8_t  BLUE_PIN{9};        //!< Blue Pin number
+const uint16_t FADE_MS{3000};      //!< Crossfade time between two scenes
+const uint16_t HOLD_MS{4000};      //!< Time each scene is held after the crossfade
+const uint8_t  LEDS{3};            //!< Levels in each scene
+const PROGMEM uint8_t DAY[LEDS]     = {255, 255, 200};  //!< Scene with red, green and blue levels
+const PROGMEM uint8_t EVENING[LEDS] = {255, 60, 0};     //!< Scene with red, green and blue levels
+const PROGMEM uint8_t NIGHT[LEDS]   = {10, 0, 40};      //!< Scene with red, green and blue levels
+const PROGMEM uint8_t OFF[LEDS]     = {0, 0, 0};        //!< Scene with red, green and blue levels
+
+const uint8_t* const SCENES[] = {DAY, EVENING, NIGHT, OFF};  //!< Scenes in the order shown
+const char* const    NAMES[]  = {"Day", "Evening", "Night", "Off"};  //!< Scene names
+
+smoothLED red,  //!< instance of smoothLED pointing to red, first entry of each scene
+    green,      //!< instance of smoothLED pointing to green, second entry of each scene
+    blue;       //!< instance of smoothLED pointing to blue, third entry of each scene
+
+void setup() {
+  /*!
+      @brief    Arduino method called once at startup to initialize the system
+      @details  This is an Arduino IDE method which is called first upon boot or restart. It is only
+                called one time and then control goes to the main "loop()" method, from which
+                control never returns
+      @return   void
+  */
+  Serial.begin(115200);
+#ifdef __AVR_ATmega32U4__  // If a 32U4 processor, wait 3 seconds
+  delay(3000);
+#endif
+  Serial.println(F("Starting Scenes example program"));
+  if (!red.begin(RED_PIN, INVERT_LED) || !green.begin(GREEN_PIN, INVERT_LED) ||
+      !blue.begin(BLUE_PIN, INVERT_LED)) {
+    Serial.println(F("Error initializing LEDs!"));
+  }  // if-then error
+}  // of method "setup()"
+
+void loop() {
+  /*!
+      @brief    Arduino method for the main program loop
+      @details  Main program for the Arduino IDE, it is an infinite loop and keeps on repeating
+      @return   void
+  */
+  static uint8_t scene{0};  // Scene shown next
+  Serial.print(F("Crossfading to "));
+  Serial.println(NAMES[scene]);
+  smoothLED::crossfadeTo(SCENES[scene], LEDS, FADE_MS);
+  while (red.isBusy() || green.isBusy() || blue.isBusy()) {}  // wait for the crossfade to end
+  delay(HOLD_MS);
+  if (++scene == sizeof(SCENES) / sizeof(SCENES[0])) scene = 0;
+}  // of method "loop()"
@@ -0,0 +1,68 @@
+/*! @file Serial_Stream.ino
+
+@section Serial_Stream_intro_section Description
+
+Example for smoothLED showing how to drive LEDs from a host computer using the binary frame protocol
+
+The sketch declares three LEDs and hands the "Serial" port to a smoothLEDStream instance. A host
+program sends 10-byte frames (see "SmoothLED.h" for the layout) and the library decodes them and
+issues the "set()" or "setNow()" calls. The host needs to pause sending when it receives an XOFF
+(0x13) character and may resume after an XON (0x11) character.
+
+@section Serial_Stream_license GNU General Public License v3.0
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU
+General Public License as published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version. This program is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details. You should have
+received a copy of the GNU General Public License along with this program.  If not, see
+<http://www.gnu.org/licenses/>.
+
+@section Serial_Stream_author Author
+
+Written by Arnd <Arnd@Zanduino.Com> at https://www.github.com/SV-Zanshin
+
+@section Serial_Stream_versions Changelog
+
+| Version| Date       | Developer  | Comments                                                      |
+| ------ | ---------- | ---------- | ------------------------------------------------------------- |
+| 1.1.0  | 2026-10-18 | SV-Zanshin | Initial coding                                                |
+*/
+
+#include "SmoothLED.h"  // Include the library
+#ifndef __AVR__
+#error This library and program is designed for Atmel ATMega processors
+#endif
+
+const uint8_t RED_PIN{11};    //!< Red Pin number
+const uint8_t GREEN_PIN{10};  //!< Green Pin number
+const uint8_t BLUE_PIN{9};    //!< Blue Pin number
+
+smoothLED red,                 //!< LED index 0 in the frames
+    green,                     //!< LED index 1 in the frames
+    blue;                      //!< LED index 2 in the frames
+smoothLEDStream host(Serial);  //!< Frame decoder reading from the serial port
+
+void setup() {
+  /*!
+      @brief    Arduino method called once at startup to initialize the system
+      @details  This is an Arduino IDE method which is called first upon boot or restart. It is only
+                called one time and then control goes to the main "loop()" method, from which
+                control never returns
+      @return   void
+  */
+  Serial.begin(115200);
+  red.begin(RED_PIN);
+  green.begin(GREEN_PIN);
+  blue.begin(BLUE_PIN);
+}  // of method "setup()"
+
+void loop() {
+  /*!
+      @brief    Arduino method for the main program loop
+      @details  Main program for the Arduino IDE, it is an infinite loop and keeps on repeating. The
+                frames are decoded and applied in the background of whatever else the loop does
+      @return   void
+  */
+  host.poll();  // decode and apply any frames received
+}  // of method "loop()"
@@ -0,0 +1,230 @@
+/*! @file Sync_Simulation.ino
+
+@section Sync_Simulation_intro_section Description
+
+Regression check of the multi-board synchronization against a simulated master on a virtual wire
+
+On real hardware the boards are connected with one wire between the sync pins (and ground). One
+board calls "smoothLED::setSync(SYNC_MASTER, pin)" and outputs a pulse at the start of every PWM
+frame, the others call "smoothLED::setSync(SYNC_SLAVE, pin)" on a pin that supports
+"attachInterrupt()" and lock their PWM frame and fader ticks to those pulses.
+
+This sketch checks both sides without a second board. First the library runs as master and the
+pulses its "pwmISR()" writes to SYNC_PIN are checked for their period and width, and the levels of
+the last PWM frame are recorded. Then the library runs as slave while a simulated master, whose
+clock differs by CLOCK_PPM parts per million, plays the recorded levels back step by step on a
+virtual wire, and "syncISR()" is called on each rising edge of that wire, just as the external
+interrupt would. The library has only one set of PWM variables per board, so the master can't run at
+the same time as the slave and its recorded frame stands in for it. As in the "Timing_Accuracy"
+example interrupts are disabled and the handlers are called directly, here in the order of their due
+times counted in CPU cycles. Both boards start the same fade at the same time and for each clock
+difference the run is done without and with synchronization. For every run a CSV line shows the
+largest PWM frame phase error in the second half of the run and the difference in ticks between the
+end of the fade on the slave and on the master. Leave SYNC_PIN unconnected while this sketch runs.
+The synchronization is only compiled into the library when "#define FRAME_SYNC_ACTIVE" in
+"SmoothLED.h" is uncommented, without it the sketch prints "frame sync not enabled" instead of the
+results.
+
+@section Sync_Simulation_license GNU General Public License v3.0
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU
+General Public License as published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version. This program is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details. You should have
+received a copy of the GNU General Public License along with this program.  If not, see
+<http://www.gnu.org/licenses/>.
+
+@section Sync_Simulation_author Author
+
+Written by Arnd <Arnd@Zanduino.Com> at https://www.github.com/SV-Zanshin
+
+@section Sync_Simulation_versions Changelog
+
+| Version| Date       | Developer  | Comments                                                      |
+| ------ | ---------- | ---------- | ------------------------------------------------------------- |
+| 1.1.0  | 2026-10-18 | SV-Zanshin | Initial coding                                                |
+*/
+
+#include "SmoothLED.h"  // Include the library
+#ifndef __AVR__
+#error This library and program is designed for Atmel ATMega processors
+#endif
+
+const uint8_t  SYNC_PIN{2};                      //!< Sync wire, has to support attachInterrupt()
+const uint8_t  PIN{4};                           //!< Pin for the LED under test
+const int16_t  CLOCK_PPM[] = {0, 2000, -5000};   //!< Master clock difference to test
+const uint16_t FADE_MS{10000};                   //!< Fade run on both boards
+const uint32_t FIRST_STEP{100000};               //!< CPU cycles until the first master step
+const uint32_t STEP_CYCLES{1024};                //!< CPU cycles per PWM step
+const uint32_t FRAME_CYCLES{256 * STEP_CYCLES};  //!< CPU cycles per PWM frame
+const uint32_t TIME_LIMIT{320000000UL};          //!< CPU cycles before a run is aborted
+
+smoothLED led;     //!< LED under test
+uint8_t   wire[32];  //!< SYNC_PIN levels of one master PWM frame, one bit per step
+
+#ifdef FRAME_SYNC_ACTIVE
+uint32_t faderCycles() {
+  /*!
+      @brief    Returns the number of CPU cycles per fader interrupt
+      @details  On the megaAVR and AVR-Dx processors the TCA0 period is set by the core, and the
+                library runs a fader tick for every millisecond collected in these interrupts
+      @return   uint32_t CPU cycles of one TIMER0 (or TCA0) period
+  */
+#ifdef SMOOTHLED_MODERN_AVR
+  static const uint8_t PRESCALER[] = {0, 1, 2, 3, 4, 6, 8, 10};  // log2 of TCA0 clock divider
+  uint8_t divider = (TCA0.SPLIT.CTRLA & TCA_SPLIT_CLKSEL_gm) >> TCA_SPLIT_CLKSEL_gp;
+  return (uint32_t)(TCA0.SPLIT.LPER + 1) << PRESCALER[divider];
+#else
+  return 16384;  // TIMER0 at 1/64 and 256 counts
+#endif
+}  // of method "faderCycles()"
+
+void checkMaster() {
+  /*!
+      @brief    Run the library as sync master and check the pulses written to SYNC_PIN
+      @details  The levels written in the last of the 4 PWM frames are kept in "wire[]"
+  */
+  uint16_t rises{0}, period{0}, width{0}, last{0};
+  smoothLED::setSync(SYNC_MASTER, SYNC_PIN);
+  uint8_t oldSREG = SREG;
+  cli();  // the real PWM interrupt must not run now
+  uint8_t previous = digitalRead(SYNC_PIN);
+  for (uint16_t step = 1; step <= 4 * 256; ++step) {
+    smoothLED::pwmISR();
+    uint8_t level = digitalRead(SYNC_PIN);
+    if (level && !previous) {  // rising edge
+      if (rises != 0) period = step - last;
+      last = step;
+      ++rises;
+    }  // if-then rising edge
+    if (!level && previous) width = step - last;
+    previous = level;
+    uint8_t index = (step - 1) & 255;  // step in the frame
+    if (level) {
+      wire[index / 8] |= 1 << (index % 8);
+    } else {
+      wire[index / 8] &= ~(1 << (index % 8));
+    }  // if-then-else high level
+  }  // for-next each PWM step
+  SREG = oldSREG;
+  smoothLED::setSync(SYNC_OFF);
+  Serial.print(F("# master pulses="));
+  Serial.print(rises);
+  Serial.print(F(" period_steps="));
+  Serial.print(period);
+  Serial.print(F(" width_steps="));
+  Serial.println(width);
+}  // of method "checkMaster()"
+
+void runSlave(const int16_t ppm, const bool sync) {
+  /*!
+      @brief    Run a fade on the slave while a simulated master drives the virtual wire
+      @details  The master's PWM steps are "PERIOD" / 256 CPU cycles apart, the fraction of a cycle
+                is carried in "fraction". In each step the next level recorded in "wire[]" is put
+                on the virtual wire and a rising edge calls "syncISR()"
+      @param[in] ppm  Master clock difference in parts per million, above 0 when it is faster
+      @param[in] sync Lock to the master when true, only measure when false
+  */
+  const uint32_t FADER{faderCycles()};
+  const uint32_t PERIOD = (uint64_t)FRAME_CYCLES * 1000000 / (1000000L + ppm);  // master frame
+  uint32_t       now{0}, nextStep{STEP_CYCLES}, nextTick{FADER}, nextMaster{FIRST_STEP};
+  uint32_t       ticks{0}, fadeEnd{0};
+  uint16_t       pulses{0};
+  uint8_t        worst{0}, masterStep{0}, fraction{0};
+  bool           level = wire[31] & 0x80;  // wire level at the end of the recorded frame
+  smoothLED::setSync(sync ? SYNC_SLAVE : SYNC_OFF, SYNC_PIN);
+  uint8_t oldSREG = SREG;
+  cli();                  // the real interrupts must not run now
+  led.setNow(0);          // start from "OFF" with nothing stacked
+  smoothLED::faderISR();  // apply it
+  led.set(255, FADE_MS);  // both boards start the fade at time 0
+  while (fadeEnd == 0 && now < TIME_LIMIT) {
+    if (nextMaster <= nextStep && nextMaster <= nextTick) {  // master PWM step
+      now        = nextMaster;
+      bool risen = !level;
+      level      = wire[masterStep / 8] & (1 << (masterStep % 8));
+      if (level && risen) {  // rising edge on the virtual wire
+        smoothLED::syncISR();
+        ++pulses;
+        int8_t error = smoothLED::syncError();
+        if (now > (uint32_t)FADE_MS * FADER / 2) {  // second half of the run
+          uint8_t size = error < 0 ? -error : error;
+          if (size > worst) worst = size;
+        }  // if-then second half
+      }    // if-then rising edge
+      ++masterStep;                                       // wraps around after 256 steps
+      uint16_t sum = fraction + (uint8_t)PERIOD;          // add the fraction of a cycle
+      nextMaster += (PERIOD >> 8) + (sum >> 8);           // and the whole cycles of one step
+      fraction = sum;
+    } else if (nextStep <= nextTick) {  // PWM step
+      now = nextStep;
+      smoothLED::pwmISR();
+      nextStep += STEP_CYCLES;
+    } else {  // fader interrupt, as in the interrupt vector
+      now = nextTick;
+#ifdef SMOOTHLED_MODERN_AVR
+      for (uint8_t n = smoothLED::syncTicks(smoothLED::faderTicks()); n != 0; --n) {
+#else
+      for (uint8_t n = smoothLED::syncTicks(); n != 0; --n) {
+#endif
+        smoothLED::faderISR();
+        ++ticks;
+      }  // for-next each tick
+      if (!led.isBusy()) fadeEnd = now;
+      nextTick += FADER;
+    }  // if-then-else next event
+  }    // while fading
+  SREG = oldSREG;
+  smoothLED::setSync(SYNC_OFF);
+#ifdef SMOOTHLED_MODERN_AVR
+  const uint32_t TICK{F_CPU / 1000};  // fader ticks are 1ms long
+#else
+  const uint32_t TICK{FADER};  // one fader tick per interrupt
+#endif
+  uint32_t masterTicks = (uint64_t)fadeEnd * (1000000L + ppm) / 1000000 / TICK;
+  Serial.print(ppm);
+  Serial.print(sync ? F(",on,") : F(",off,"));
+  Serial.print(pulses);
+  Serial.print(',');
+  Serial.print(worst);
+  Serial.print(',');
+  Serial.print(ticks);
+  Serial.print(',');
+  Serial.print(masterTicks);
+  Serial.print(',');
+  Serial.println((int32_t)masterTicks - (int32_t)ticks);
+}  // of method "runSlave()"
+#endif
+
+void setup() {
+  /*!
+      @brief    Arduino method called once at startup to initialize the system
+      @details  This is an Arduino IDE method which is called first upon boot or restart. It is only
+                called one time and then control goes to the main "loop()" method, from which
+                control never returns
+      @return   void
+  */
+  Serial.begin(115200);
+#ifdef __AVR_ATmega32U4__  // If a 32U4 processor, wait 3 seconds
+  delay(3000);
+#endif
+  led.begin(PIN, SOFTWARE_MODE);
+#ifdef FRAME_SYNC_ACTIVE
+  checkMaster();
+  Serial.println(F("ppm,sync,pulses,max_phase_error,slave_ticks,master_ticks,end_difference"));
+  for (uint8_t i = 0; i < sizeof(CLOCK_PPM) / sizeof(CLOCK_PPM[0]); ++i) {
+    runSlave(CLOCK_PPM[i], false);
+    runSlave(CLOCK_PPM[i], true);
+  }  // for-next each clock difference
+#else
+  Serial.println(F("frame sync not enabled, uncomment FRAME_SYNC_ACTIVE in SmoothLED.h"));
+#endif
+}  // of method "setup()"
+
+void loop() {
+  /*!
+      @brief    Arduino method for the main program loop
+      @details  Nothing to do, the checks run once in "setup()"
+      @return   void
+  */
+}  // of method "loop()"
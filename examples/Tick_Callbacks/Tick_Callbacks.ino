@@ -0,0 +1,99 @@
+/*! @file Tick_Callbacks.ino
+
+@section Tick_Callbacks_intro_section Description
+
+Example for smoothLED showing how to run a button debounce off the fader interrupt
+
+The library already uses the TIMER0 compare interrupt (TCA0 on the megaAVR and AVR-Dx processors)
+about every millisecond for fading. Instead of using another timer or polling millis() in "loop()",
+short functions can be attached to that interrupt with "smoothLEDTick::attach()". This sketch
+debounces a push button between BUTTON_PIN and ground every 5 ticks and fades the built-in LED on or
+off for each press. The callback only sets a flag, the "set()" call is done in "loop()". Every 5
+seconds the largest measured cost of the callback is written to the serial port.
+
+@section Tick_Callbacks_license GNU General Public License v3.0
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU
+General Public License as published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version. This program is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details. You should have
+received a copy of the GNU General Public License along with this program.  If not, see
+<http://www.gnu.org/licenses/>.
+
+@section Tick_Callbacks_author Author
+
+Written by Arnd <Arnd@Zanduino.Com> at https://www.github.com/SV-Zanshin
+
+@section Tick_Callbacks_versions Changelog
+
+| Version| Date       | Developer  | Comments                                                      |
+| ------ | ---------- | ---------- | ------------------------------------------------------------- |
+| 1.1.0  | 2026-10-18 | SV-Zanshin | Initial coding                                                |
+*/
+
+#include "SmoothLED.h"  // Include the library
+#ifndef __AVR__
+#error This library and program is designed for Atmel ATMega processors
+#endif
+
+const uint8_t BUTTON_PIN{2};   //!< Push button to ground, uses the internal pull-up
+const uint8_t DEBOUNCE{4};     //!< Number of equal samples for a stable state, 4 * 5ms = 20ms
+smoothLED     Board;           //!< instance of smoothLED pointing to the builtin LED
+volatile bool pressed{false};  //!< Set by the callback for each press, cleared by "loop()"
+
+void debounce() {
+  /*!
+      @brief    Tick callback, samples the button and sets "pressed" once it has been stable
+      @details  Called from the fader interrupt every 5ms with interrupts disabled, so it has to be
+                short. "digitalRead()" is fast enough for the default budget of 512 CPU cycles
+  */
+  static uint8_t stable{HIGH};  // debounced state, HIGH is released
+  static uint8_t count{0};      // equal samples in a row that differ from the stable state
+  uint8_t        sample = digitalRead(BUTTON_PIN);
+  if (sample == stable) {
+    count = 0;  // no change
+  } else if (++count == DEBOUNCE) {
+    stable = sample;  // changed for long enough
+    count  = 0;
+    if (stable == LOW) pressed = true;  // button went down
+  }                                     // if-then-else changed
+}  // of method "debounce()"
+
+void setup() {
+  /*!
+      @brief    Arduino method called once at startup to initialize the system
+      @details  This is an Arduino IDE method which is called first upon boot or restart. It is only
+                called one time and then control goes to the main "loop()" method, from which
+                control never returns
+      @return   void
+  */
+  Serial.begin(115200);
+#ifdef __AVR_ATmega32U4__  // If a 32U4 processor, wait 3 seconds
+  delay(3000);
+#endif
+  pinMode(BUTTON_PIN, INPUT_PULLUP);
+  Board.begin(LED_BUILTIN);
+  if (!smoothLEDTick::attach(debounce, 5)) Serial.println(F("No free tick callback entry"));
+}  // of method "setup()"
+
+void loop() {
+  /*!
+      @brief    Arduino method for the main program loop
+      @details  Fades the LED on or off for each button press and reports the callback cost
+      @return   void
+  */
+  static bool          on{false};    // LED state
+  static unsigned long lastReport{0};
+  if (pressed) {
+    pressed = false;
+    on      = !on;
+    Board.setNow(on ? 255 : 0, 500);  // fade over half a second
+  }                                   // if-then button pressed
+  if (millis() - lastReport >= 5000) {
+    lastReport = millis();
+    Serial.print(F("debounce() worst case "));
+    Serial.print(smoothLEDTick::cost(debounce) * 64UL);
+    Serial.print(F(" CPU cycles, overruns "));
+    Serial.println(smoothLEDTick::overruns());
+  }  // if-then report due
+}  // of method "loop()"
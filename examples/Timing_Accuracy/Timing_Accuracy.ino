@@ -0,0 +1,230 @@
+/*! @file Timing_Accuracy.ino
+
+@section Timing_Accuracy_intro_section Description
+
+Regression check comparing the real fade and delay durations with the requested values
+
+The "set(val, speed, delay)" call promises a fade over "speed" milliseconds followed by a pause of
+"delay" milliseconds, but the internal rate computation uses integer arithmetic and is clamped, so
+the actual duration differs from the requested one. This sketch measures that difference on a
+simulated timeline: interrupts are disabled and "faderISR()" is called directly, each call being one
+fader tick, until "isBusy()" returns false. Every combination of level change, speed and delay is
+run through "setNow()" and "set()" (the immediate path) and through a stacked "set()" (the queued
+path). For every run the actual number of ticks and the largest difference between the actual level
+and an ideal linear fade are written to the serial port as a CSV line, followed by a summary of the
+error distribution. Finally several LEDs run the same sequence of stacked commands at the same time
+to check that each LED's timing is independent of its position in the list and of the other LEDs
+starting stacked commands in the same tick. On the hardware the fader tick is 1.024ms (TIMER0
+compare match), this constant factor is not included in the numbers.
+
+@section Timing_Accuracy_license GNU General Public License v3.0
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU
+General Public License as published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version. This program is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details. You should have
+received a copy of the GNU General Public License along with this program.  If not, see
+<http://www.gnu.org/licenses/>.
+
+@section Timing_Accuracy_author Author
+
+Written by Arnd <Arnd@Zanduino.Com> at https://www.github.com/SV-Zanshin
+
+@section Timing_Accuracy_versions Changelog
+
+| Version| Date       | Developer  | Comments                                                      |
+| ------ | ---------- | ---------- | ------------------------------------------------------------- |
+| 1.1.0  | 2026-10-18 | SV-Zanshin | Initial coding                                                |
+*/
+
+#include "SmoothLED.h"  // Include the library
+#ifndef __AVR__
+#error This library and program is designed for Atmel ATMega processors
+#endif
+
+const uint8_t  DELTAS[] = {1, 10, 64, 128, 255};              //!< Level changes to test
+const uint16_t SPEEDS[] = {10, 100, 500, 1000, 5000, 30000};  //!< Fade speeds in ms to test
+const uint16_t DELAYS[] = {0, 100};                           //!< Post-fade delays to test
+const uint8_t  PATHS{2};                                      //!< 0 is immediate, 1 is stacked
+const uint8_t  PIN{LED_BUILTIN};                              //!< Pin for the LED under test
+const uint8_t  MULTI_LEDS{4};                                 //!< LEDs in the multi-LED test
+const uint8_t  MULTI_FIRST_PIN{4};                            //!< First pin of the multi-LED test
+
+smoothLED led;                //!< LED under test
+smoothLED multi[MULTI_LEDS];  //!< LEDs for the multi-LED test
+
+/*! @brief Error distribution over all runs */
+struct errorStats {
+  int32_t  sum{0};       //!< Sum of errors in ticks
+  int16_t  lowest{0};    //!< Smallest (most negative) error
+  int16_t  highest{0};   //!< Largest error
+  uint16_t runs{0};      //!< Number of runs
+  uint8_t  levelDev{0};  //!< Largest level deviation from a linear fade
+};  // of struct "errorStats"
+
+errorStats stats[PATHS];  //!< Results for the immediate and stacked paths
+
+void run(const uint8_t path, const uint8_t delta, const uint16_t speed, const uint16_t delay) {
+  /*!
+      @brief    Measure one fade on the simulated timeline and print the result
+      @param[in] path  0 to start the fade directly, 1 to stack it behind a short pause
+      @param[in] delta Level change of the fade, always from 0 upwards
+      @param[in] speed Requested fade time in ms
+      @param[in] delay Requested delay after the fade in ms
+  */
+  const uint16_t PAUSE{10};  // ticks of the command the stacked fade waits behind
+  uint8_t        oldSREG = SREG;
+  cli();                           // the real fader interrupt must not run now
+  led.setNow(0);                   // start from "OFF" with nothing stacked
+  smoothLED::faderISR();           // apply it
+  if (path == 1) {                 // stacked path
+    led.set(0, 0, PAUSE);          // pause first,
+    led.set(delta, speed, delay);  // so that this one is stacked
+    for (uint16_t i = 0; i < PAUSE; ++i) smoothLED::faderISR();
+  } else {
+    led.set(delta, speed, delay);  // starts immediately
+  }                                // if-then-else stacked path
+  uint32_t ticks{0};
+  uint8_t  levelDev{0};
+  while (led.isBusy() && ticks < 70000UL) {
+    smoothLED::faderISR();
+    ++ticks;
+    if (ticks <= speed) {  // compare against a linear fade while fading
+      uint8_t ideal = (uint32_t)delta * ticks / speed;
+      uint8_t level = led.getLevel();
+      uint8_t dev   = level > ideal ? level - ideal : ideal - level;
+      if (dev > levelDev) levelDev = dev;
+    }  // if-then still fading
+  }    // while LED busy
+  SREG = oldSREG;
+  int16_t error = (int32_t)ticks - speed - delay;
+  Serial.print(path ? F("stacked,") : F("immediate,"));
+  Serial.print(delta);
+  Serial.print(',');
+  Serial.print(speed);
+  Serial.print(',');
+  Serial.print(delay);
+  Serial.print(',');
+  Serial.print(ticks);
+  Serial.print(',');
+  Serial.print(error);
+  Serial.print(',');
+  Serial.print(error * 100.0 / (speed + delay), 2);
+  Serial.print(',');
+  Serial.println(levelDev);
+  errorStats& s = stats[path];
+  if (s.runs == 0 || error < s.lowest) s.lowest = error;
+  if (s.runs == 0 || error > s.highest) s.highest = error;
+  if (levelDev > s.levelDev) s.levelDev = levelDev;
+  s.sum += error;
+  ++s.runs;
+}  // of method "run()"
+
+void runMulti() {
+  /*!
+      @brief    Run the same stacked sequence on several LEDs at once and print each LED's duration
+      @details  The fade "set(128, 100)" needs 128 steps in 100ms, but the fader does at most one
+                step per tick, so it takes 28 ticks longer. Each LED's error has to be within one
+                tick of that known clamp, like the single runs, and all LEDs have to finish in the
+                same tick
+  */
+  const uint16_t EXPECTED{300 + 300 + 20 + 100 + 200};  // sum of speeds and delays below
+  const int16_t  CLAMPED{128 - 100};                    // extra ticks of "set(128, 100)"
+  uint32_t       ticks[MULTI_LEDS]{0};
+  uint8_t        oldSREG = SREG;
+  cli();  // the real fader interrupt must not run now
+  for (uint8_t i = 0; i < MULTI_LEDS; ++i) multi[i].setNow(0);
+  smoothLED::faderISR();  // apply it
+  for (uint8_t i = 0; i < MULTI_LEDS; ++i) {
+    multi[i].set(255, 300);    // starts immediately
+    multi[i].set(0, 300, 20);  // the rest are stacked
+    multi[i].set(128, 100);
+    multi[i].set(0, 200);
+  }  // for-next each LED
+  bool     busy{true};
+  uint32_t tick{0};
+  while (busy && tick < 70000UL) {
+    smoothLED::faderISR();
+    ++tick;
+    busy = false;
+    for (uint8_t i = 0; i < MULTI_LEDS; ++i) {
+      if (multi[i].isBusy()) {
+        busy     = true;
+        ticks[i] = tick + 1;  // finished at the earliest in the next tick
+      }                       // if-then LED still busy
+    }                         // for-next each LED
+  }                           // while any LED busy
+  SREG = oldSREG;
+  uint32_t lowest{ticks[0]}, highest{ticks[0]};
+  bool     inBound{true};  // all errors within one tick of the clamp
+  for (uint8_t i = 0; i < MULTI_LEDS; ++i) {
+    int32_t error = (int32_t)ticks[i] - EXPECTED;
+    Serial.print(F("multi,"));
+    Serial.print(i);
+    Serial.print(',');
+    Serial.print(ticks[i]);
+    Serial.print(',');
+    Serial.println(error);
+    if (error < CLAMPED - 1 || error > CLAMPED + 1) inBound = false;
+    if (ticks[i] < lowest) lowest = ticks[i];
+    if (ticks[i] > highest) highest = ticks[i];
+  }  // for-next each LED
+  Serial.print(F("# multi leds="));
+  Serial.print(MULTI_LEDS);
+  Serial.print(F(" expected="));
+  Serial.print(EXPECTED);
+  Serial.print(F(" clamp_error="));
+  Serial.print(CLAMPED);
+  Serial.print(F(" spread="));
+  Serial.print(highest - lowest);
+  Serial.println(inBound && highest == lowest ? F(" PASS") : F(" FAIL"));
+}  // of method "runMulti()"
+
+void setup() {
+  /*!
+      @brief    Arduino method called once at startup to initialize the system
+      @details  This is an Arduino IDE method which is called first upon boot or restart. It is only
+                called one time and then control goes to the main "loop()" method, from which
+                control never returns
+      @return   void
+  */
+  Serial.begin(115200);
+#ifdef __AVR_ATmega32U4__  // If a 32U4 processor, wait 3 seconds
+  delay(3000);
+#endif
+  led.begin(PIN, SOFTWARE_MODE);
+  for (uint8_t i = 0; i < MULTI_LEDS; ++i) multi[i].begin(MULTI_FIRST_PIN + i, SOFTWARE_MODE);
+  Serial.println(F("path,delta,speed,delay,ticks,error_ticks,error_pct,max_level_dev"));
+  for (uint8_t path = 0; path < PATHS; ++path) {
+    for (uint8_t d = 0; d < sizeof(DELTAS); ++d) {
+      for (uint8_t s = 0; s < sizeof(SPEEDS) / sizeof(SPEEDS[0]); ++s) {
+        for (uint8_t w = 0; w < sizeof(DELAYS) / sizeof(DELAYS[0]); ++w) {
+          run(path, DELTAS[d], SPEEDS[s], DELAYS[w]);
+        }  // for-next each delay
+      }    // for-next each speed
+    }      // for-next each delta
+  }        // for-next each path
+  for (uint8_t path = 0; path < PATHS; ++path) {
+    Serial.print(path ? F("# stacked") : F("# immediate"));
+    Serial.print(F(" runs="));
+    Serial.print(stats[path].runs);
+    Serial.print(F(" min_error="));
+    Serial.print(stats[path].lowest);
+    Serial.print(F(" max_error="));
+    Serial.print(stats[path].highest);
+    Serial.print(F(" mean_error="));
+    Serial.print((float)stats[path].sum / stats[path].runs, 2);
+    Serial.print(F(" max_level_dev="));
+    Serial.println(stats[path].levelDev);
+  }  // for-next each path
+  Serial.println(F("multi,led,ticks,error_ticks"));
+  runMulti();
+}  // of method "setup()"
+
+void loop() {
+  /*!
+      @brief    Arduino method for the main program loop
+      @details  Nothing to do, the measurements run once in "setup()"
+      @return   void
+  */
+}  // of method "loop()"
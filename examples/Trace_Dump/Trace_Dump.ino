@@ -0,0 +1,93 @@
+/*! @file Trace_Dump.ino
+
+@section Trace_Dump_intro_section Description
+
+Example for smoothLED showing how to record and dump the interrupt event trace
+
+The trace is only compiled into the library when "#define SMOOTHLED_TRACE" in "SmoothLED.h" is
+uncommented. The sketch stacks more commands than the ring of one LED holds, cancels them again with
+"setNow()" and starts a slow fade on a second LED, then writes the last TRACE_SIZE recorded events
+to the serial port with "smoothLED::dumpTrace()". Each time a character is received on the serial
+port the sequence is run again. Save the output to a file and render it as a timeline with "python3
+extras/trace_decode.py trace.txt". Without SMOOTHLED_TRACE the sketch still runs the sequence, but
+prints "tracing not enabled" instead of the trace.
+
+@section Trace_Dump_license GNU General Public License v3.0
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU
+General Public License as published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version. This program is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details. You should have
+received a copy of the GNU General Public License along with this program.  If not, see
+<http://www.gnu.org/licenses/>.
+
+@section Trace_Dump_author Author
+
+Written by Arnd <Arnd@Zanduino.Com> at https://www.github.com/SV-Zanshin
+
+@section Trace_Dump_versions Changelog
+
+| Version| Date       | Developer  | Comments                                                      |
+| ------ | ---------- | ---------- | ------------------------------------------------------------- |
+| 1.1.0  | 2026-10-18 | SV-Zanshin | Initial coding                                                |
+*/
+
+#include "SmoothLED.h"  // Include the library
+#ifndef __AVR__
+#error This library and program is designed for Atmel ATMega processors
+#endif
+
+const uint8_t HARDWARE_PIN{LED_BUILTIN};  //!< LED using hardware PWM if the pin supports it
+const uint8_t SOFTWARE_PIN{4};            //!< LED using software PWM
+
+smoothLED hardwareLED,  //!< LED 0 in the trace
+    softwareLED;        //!< LED 1 in the trace
+
+void runSequence() {
+  /*!
+      @brief    Run a short sequence of commands and dump the trace
+  */
+  hardwareLED.setNow(0);               // start from "OFF" with nothing stacked
+  softwareLED.setNow(0);               // for both LEDs
+  delay(20);                           // and let the interrupts settle
+  for (uint8_t i = 0; i <= SET_QUEUE_SIZE; ++i) {
+    hardwareLED.set(i & 1 ? 255 : 0);  // stack more commands than fit, the last one is lost
+  }                                    // for-next each command
+  hardwareLED.setNow(64);              // cancel the stacked commands
+  softwareLED.set(16, 100);            // slow fade, recorded as one fade step every 6ms
+  delay(150);                          // wait until everything is done
+#ifdef SMOOTHLED_TRACE
+  smoothLED::dumpTrace(Serial);        // and write the last events to the serial port
+#else
+  Serial.println(F("tracing not enabled, uncomment \"#define SMOOTHLED_TRACE\" in SmoothLED.h"));
+#endif
+}  // of method "runSequence()"
+
+void setup() {
+  /*!
+      @brief    Arduino method called once at startup to initialize the system
+      @details  This is an Arduino IDE method which is called first upon boot or restart. It is only
+                called one time and then control goes to the main "loop()" method, from which
+                control never returns
+      @return   void
+  */
+  Serial.begin(115200);
+#ifdef __AVR_ATmega32U4__  // If a 32U4 processor, wait 3 seconds
+  delay(3000);
+#endif
+  hardwareLED.begin(HARDWARE_PIN);
+  softwareLED.begin(SOFTWARE_PIN, SOFTWARE_MODE);
+  runSequence();
+}  // of method "setup()"
+
+void loop() {
+  /*!
+      @brief    Arduino method for the main program loop
+      @details  Runs the sequence again whenever a character is received on the serial port
+      @return   void
+  */
+  if (Serial.available()) {
+    while (Serial.available()) Serial.read();  // discard the input
+    runSequence();
+  }  // if-then character received
+}  // of method "loop()"
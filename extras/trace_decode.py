@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""Render the output of "smoothLED::dumpTrace()" as a timeline.
+
+The library has to be compiled with "#define SMOOTHLED_TRACE" in "SmoothLED.h". Save what the
+sketch writes to the serial port (see the "Trace_Dump" example) to a file and run
+
+    python3 trace_decode.py trace.txt
+
+or pipe it into the program. Each dump starts with a "# smoothLED trace" header line and is
+followed by "time,type,led,value" lines, oldest first. The 16-bit timestamps are unwrapped and
+converted to microseconds relative to the first event of the dump. After the timeline a summary
+lists the number of each event type, the spacing of the PWM frames and of the fader runs and the
+number of interrupt overruns, which are the usual suspects when an LED flickers.
+"""
+
+import argparse
+import re
+import sys
+
+EVENTS = ["FRAME", "FADER", "STEP", "DEQUEUE", "CANCEL", "TIMER", "OVERRUN", "FULL"]
+TIMERS = ["fader interrupt off", "fader interrupt on", "PWM interrupt off", "PWM interrupt on"]
+HANDLERS = ["pwmISR()", "faderISR()"]
+PWM_CYCLES = 256 * 1024  # CPU cycles per software PWM frame (256 steps of 1024 cycles)
+FADER_CYCLES = 16384  # CPU cycles per fader tick when the header has no "fader=" (TIMER0)
+JITTER = 16  # backwards steps smaller than one PWM step are reordered events, not a wrap
+
+
+def describe(kind, led, value):
+    """Return the text for one event."""
+    if kind == 0:
+        return "pwmISR() frame start"
+    if kind == 1:
+        return "faderISR() run, %d tick(s) skipped before it" % value
+    if kind == 2:
+        return "LED %d fade step to level %d" % (led, value)
+    if kind == 3:
+        return "LED %d stacked command started, target %d" % (led, value)
+    if kind == 4:
+        return "LED %d setNow() cancel, active action ended at %d" % (led, value)
+    if kind == 5:
+        return TIMERS[value] if value < len(TIMERS) else "timer switch %d" % value
+    if kind == 6:
+        if value == 2:
+            return "OVERRUN: tick callback %d over its budget, detached" % led
+        name = HANDLERS[value] if value < len(HANDLERS) else str(value)
+        return "OVERRUN: next %s interrupt was already pending" % name
+    return "LED %d set() to %d ignored, ring full" % (led, value)
+
+
+def spacing(label, times, reference):
+    """Print the minimum, mean and maximum distance between consecutive times."""
+    if len(times) < 2:
+        return
+    gaps = [b - a for a, b in zip(times, times[1:])]
+    print(
+        "  %-7s spacing min %.1fus mean %.1fus max %.1fus (%s)"
+        % (label, min(gaps), sum(gaps) / len(gaps), max(gaps), reference)
+    )
+
+
+def render(header, rows, lanes):
+    """Print the timeline and summary of one dump."""
+    cpu = int(re.search(r"F_CPU=(\d+)", header).group(1))
+    unit = int(re.search(r"unit=(\d+)", header).group(1))
+    fader = re.search(r"fader=(\d+)", header)
+    fader = int(fader.group(1)) if fader else FADER_CYCLES
+    us_per_unit = unit * 1e6 / cpu
+    print(header)
+    if not rows:
+        print("  no events recorded")
+        return
+    ticks, previous = 0, rows[0][0]
+    frames, faders, counts = [], [], [0] * len(EVENTS)
+    leds = max(led for _, _, led, _ in rows) + 1
+    for stamp, kind, led, value in rows:
+        delta = (stamp - previous) & 0xFFFF
+        if delta > 0x10000 - JITTER:  # slightly out of order, not a wrap
+            delta -= 0x10000
+        ticks += delta
+        previous = stamp
+        time = ticks * us_per_unit
+        counts[kind] += 1
+        if kind == 0:
+            frames.append(time)
+        elif kind == 1:
+            faders.append(time)
+        lane = ""
+        if lanes:  # one column per LED, with the event's initial in the LED's column
+            cells = ["."] * leds
+            if kind in (2, 3, 4, 7):
+                cells[led] = EVENTS[kind][0]
+            lane = " ".join(cells) + "  "
+        print("%12.1fus  %s%-8s %s" % (time, lane, EVENTS[kind], describe(kind, led, value)))
+    print("Summary:")
+    print("  " + ", ".join("%s %d" % (name, n) for name, n in zip(EVENTS, counts) if n))
+    spacing("FRAME", frames, "nominal %.1fus" % (PWM_CYCLES * 1e6 / cpu))
+    spacing("FADER", faders, "tick %.1fus, longer while sleeping" % (fader * 1e6 / cpu))
+    if counts[6]:
+        print("  %d interrupt overrun(s), a handler took longer than its period" % counts[6])
+
+
+def main():
+    """Parse the command line and decode all dumps in the input."""
+    parser = argparse.ArgumentParser(description="Render smoothLED trace dumps as a timeline")
+    parser.add_argument("file", nargs="?", help="saved serial output, default is stdin")
+    parser.add_argument("--lanes", action="store_true", help="add one column per LED")
+    args = parser.parse_args()
+    source = open(args.file) if args.file else sys.stdin
+    header, rows = None, []
+    for line in source:
+        line = line.strip()
+        if line.startswith("# smoothLED trace"):
+            if header:
+                render(header, rows, args.lanes)
+                print()
+            header, rows = line, []
+        elif header and re.match(r"^\d+,\d+,\d+,\d+$", line):
+            rows.append(tuple(int(field) for field in line.split(",")))
+    if header:
+        render(header, rows, args.lanes)
+    else:
+        sys.exit("No \"# smoothLED trace\" header found in the input")
+
+
+if __name__ == "__main__":
+    main()
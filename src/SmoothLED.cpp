@@ -7,14 +7,175 @@ See main library header file for details
 
 #include "SmoothLED.h"
 
-#define fadeTimerOn TIMSK0 |= _BV(OCIE0A);    //!< Enable the interrupt on TIMER0 Match A
-#define fadeTimerOff TIMSK0 &= ~_BV(OCIE0A);  //!< Disable the interrupt on TIMER0 Match A
-#define pwmTimerOn TIMSK1 |= _BV(TOIE1);      //!< Enable the interrupt on TIMER1 Overflow
-#define pwmTimerOff TIMSK1 &= ~_BV(TOIE1);    //!< Disable the interrupt on TIMER0 Overflow
-const uint8_t PWM_ACTIVE{8};                  //!< Set when PWM is active on the pin (not 0 or 255)
-const uint8_t TIMER1_PIN{16};                 //!< Set pin is on TIMER1, needs special handling
-smoothLED *smoothLED::_firstLink{nullptr};    // static member declaration outside of class for init
-uint8_t    smoothLED::_counterPWM{0};         // static pwm loop counter
+#ifdef SMOOTHLED_TRACE
+#define traceEvent(type, led, value) \
+  smoothLED::trace((type) << 5 | ((led)&0x1F), value)  //!< Write an event
+#define traceTimer(state, value) \
+  (!(state) != !((value)&1) ? smoothLED::trace(TRACE_TIMER << 5, value) : (void)0)  //!< Trace
+#else
+#define traceEvent(type, led, value) (void)0  //!< Tracing is disabled
+#define traceTimer(state, value) (void)0      //!< Tracing is disabled
+#endif
+#ifdef FRAME_SYNC_ACTIVE
+#define syncFader (smoothLED::_syncMode == SYNC_SLAVE)  //!< Slave counts every fader tick
+#define syncPWM (smoothLED::_syncMode == SYNC_MASTER)   //!< Master pulses from every PWM frame
+#else
+#define syncFader false  //!< Synchronization is disabled
+#define syncPWM false    //!< Synchronization is disabled
+#endif
+#ifdef SMOOTHLED_MODERN_AVR
+#define fadeActive (TCA0.SPLIT.INTCTRL & TCA_SPLIT_LUNF_bm)       //!< Fader interrupt is enabled
+#define pwmActive (SMOOTHLED_TCB.INTCTRL & TCB_CAPT_bm)           //!< PWM interrupt is enabled
+#define fadePending (TCA0.SPLIT.INTFLAGS & TCA_SPLIT_LUNF_bm)     //!< Fader interrupt is due
+#define pwmPending (SMOOTHLED_TCB.INTFLAGS & TCB_CAPT_bm)         //!< PWM interrupt is due
+#define tickCount TCA0.SPLIT.LCNT  //!< Down counter from LPER, see "tickCost()"
+#ifdef SMOOTHLED_TRACE
+#define traceClock true  //!< The trace timestamp needs the TCA0 underflows counted by the fader
+#else
+#define traceClock false  //!< The fader interrupt can be turned off when idle
+#endif
+#define fadeTimerOn                          \
+  do {                                       \
+    memoryBarrier;                           \
+    smoothLED::_sleepTicks = 0;              \
+    traceTimer(fadeActive, TRACE_FADE_ON);   \
+    TCA0.SPLIT.INTCTRL |= TCA_SPLIT_LUNF_bm; \
+  } while (0)  //!< Wake fader interrupt
+#define fadeTimerOff                                  \
+  do {                                                \
+    if (smoothLEDTick::_clients == 0 && !syncFader && !traceClock) { \
+      traceTimer(fadeActive, TRACE_FADE_OFF);                        \
+      TCA0.SPLIT.INTCTRL &= ~TCA_SPLIT_LUNF_bm;                      \
+    }                                                                \
+  } while (0)  //!< Disable the TCA0 low underflow interrupt unless callbacks, sync or trace need it
+#define pwmTimerOn                       \
+  do {                                   \
+    traceTimer(pwmActive, TRACE_PWM_ON); \
+    SMOOTHLED_TCB.INTCTRL = TCB_CAPT_bm; \
+  } while (0)  //!< Enable the TCB interrupt
+#define pwmTimerOff                         \
+  do {                                      \
+    if (!syncPWM) {                         \
+      traceTimer(pwmActive, TRACE_PWM_OFF); \
+      SMOOTHLED_TCB.INTCTRL = 0;            \
+    }                                       \
+  } while (0)  //!< Disable the TCB interrupt unless a sync master needs it
+#else
+#define fadeActive (TIMSK0 & _BV(OCIE0A))  //!< Fader interrupt is enabled
+#define pwmActive (TIMSK1 & _BV(TOIE1))    //!< PWM interrupt is enabled
+#define fadePending (TIFR0 & _BV(OCF0A))   //!< Fader interrupt is due
+#define pwmPending (TIFR1 & _BV(TOV1))     //!< PWM interrupt is due
+#define tickCount TCNT0                    //!< Up counter, 64 CPU cycles, see "tickCost()"
+#define fadeTimerOn                        \
+  do {                                     \
+    memoryBarrier;                         \
+    smoothLED::_sleepTicks = 0;            \
+    traceTimer(fadeActive, TRACE_FADE_ON); \
+    TIMSK0 |= _BV(OCIE0A);                 \
+  } while (0)  //!< Wake fader interrupt
+#define fadeTimerOff                                  \
+  do {                                                \
+    if (smoothLEDTick::_clients == 0 && !syncFader) { \
+      traceTimer(fadeActive, TRACE_FADE_OFF);         \
+      TIMSK0 &= ~_BV(OCIE0A);                         \
+    }                                                 \
+  } while (0)  //!< Disable the interrupt on TIMER0 Match A unless tick callbacks or sync need it
+#define pwmTimerOn                       \
+  do {                                   \
+    traceTimer(pwmActive, TRACE_PWM_ON); \
+    TIMSK1 |= _BV(TOIE1);                \
+  } while (0)  //!< Enable the interrupt on TIMER1 Overflow
+#define pwmTimerOff                         \
+  do {                                      \
+    if (!syncPWM) {                         \
+      traceTimer(pwmActive, TRACE_PWM_OFF); \
+      TIMSK1 &= ~_BV(TOIE1);                \
+    }                                       \
+  } while (0)  //!< Disable the interrupt on TIMER1 Overflow unless a sync master needs it
+#ifdef SMOOTHLED_TRACE
+extern volatile unsigned long timer0_overflow_count;  // millis() overflow counter of the core
+#endif
+#endif
+#define memoryBarrier __asm__ __volatile__("" ::: "memory")  //!< Keep order of memory accesses
+#ifdef SMOOTHLED_MODERN_AVR
+static uint16_t tcaPrescaler() {
+  /*!
+    @brief   Returns the number of CPU cycles per TCA0 count, as set up by the Arduino core
+    @return  uint16_t TCA0 clock divider from 1 to 1024
+  */
+  static const uint8_t PRESCALER[] = {0, 1, 2, 3, 4, 6, 8, 10};  // log2 of TCA0 clock divider
+  return 1 << PRESCALER[(TCA0.SPLIT.CTRLA & TCA_SPLIT_CLKSEL_gm) >> TCA_SPLIT_CLKSEL_gp];
+}  // of function "tcaPrescaler()"
+static uint8_t tickCost(const uint8_t start, const uint8_t end) {
+  /*!
+    @brief     Returns the time between two reads of "tickCount" in units of 64 CPU cycles
+    @details   TCA0 counts down from LPER to 0 with the clock divider chosen by the core, which is
+               64 on most of them, so the counts are converted to 64 cycle units. A single underflow
+               between the reads is taken into account, so the result is correct for up to one TCA0
+               period and within one TCA0 count, e.g. 4 units with a divider of 256
+    @param[in] start Count before the measured code
+    @param[in] end   Count after the measured code
+    @return    uint8_t elapsed time in units of 64 CPU cycles, limited to 255
+  */
+  uint16_t counts = start - end;                                 // the counter runs down
+  if (end > start) counts += TCA0.SPLIT.LPER + 1;                // and wraps at LPER
+  uint32_t units = ((uint32_t)counts * tcaPrescaler()) >> 6;     // 64 cycle units
+  return units > UINT8_MAX ? UINT8_MAX : units;
+}  // of function "tickCost()"
+const uint16_t FADER_PHASE{F_CPU / 16000UL};             //!< 1ms fader tick in units of 16 cycles
+const uint16_t SYNC_NOMINAL{(1UL << 22) / FADER_PHASE};  //!< Fader ticks per PWM frame * 256
+#else
+const uint16_t SYNC_NOMINAL{4096};  //!< Fader ticks per PWM frame * 256, 2^18 / 16384 cycles
+static inline uint8_t tickCost(const uint8_t start, const uint8_t end) {
+  /*!
+    @brief     Returns the time between two reads of "tickCount" in units of 64 CPU cycles
+    @details   TCNT0 counts up from 0 to 255 in units of 64 CPU cycles, so the 8-bit difference is
+               correct across an overflow for up to one TIMER0 period
+    @param[in] start Count before the measured code
+    @param[in] end   Count after the measured code
+    @return    uint8_t elapsed time in units of 64 CPU cycles
+  */
+  return end - start;
+}  // of function "tickCost()"
+#endif
+smoothLED       *smoothLED::_firstLink{nullptr};   // static member declaration outside of class
+smoothLED::ledGroup *smoothLED::_firstGroup{nullptr};  // static list of "smoothLEDT" types
+uint8_t          smoothLED::_counterPWM{0};        // static pwm loop counter
+volatile uint8_t smoothLED::_sleepTicks{0};        // static fader ticks to skip
+uint8_t          smoothLED::_skippedTicks{0};      // static fader ticks skipped so far
+volatile bool    smoothLED::_refreshAll{false};    // static flag to recompute all outputs
+uint16_t         smoothLED::_random{0xACE1};       // static effect random state, never 0
+volatile bool    smoothLED::_sceneActive{false};   // static flag that a crossfade is running
+volatile bool    smoothLED::_sceneStart{false};    // static flag that a crossfade starts
+uint32_t         smoothLED::_sceneStep{0};         // static crossfade progress per tick
+uint32_t         smoothLED::_sceneProgress{0};     // static crossfade progress, up to SCENE_END
+#ifdef SMOOTHLED_MODERN_AVR
+uint16_t smoothLED::_faderStep{FADER_PHASE};  // static TCA0 underflow period, set in begin()
+uint16_t smoothLED::_faderPhase{0};           // static cycles/16 collected for the next tick
+#endif
+smoothLEDTick::tickEntry smoothLEDTick::_table[TICK_CALLBACKS];  // static table of tick callbacks
+uint8_t                  smoothLEDTick::_clients{0};             // static number of callbacks
+uint8_t                  smoothLEDTick::_overruns{0};            // static callbacks over budget
+#ifdef FRAME_SYNC_ACTIVE
+uint8_t               smoothLED::_syncMode{SYNC_OFF};  // static synchronization mode
+uint8_t               smoothLED::_syncPin{0};          // static pin of the sync pulses
+smoothLED::ioRegister smoothLED::_syncPort{nullptr};   // static master output PORT register
+uint8_t               smoothLED::_syncMask{0};         // static master output bit mask
+uint8_t               smoothLED::_syncTicks{0};        // static fader ticks since the last pulse
+int16_t               smoothLED::_syncPhase{0};        // static fader ticks behind master * 256
+int8_t                smoothLED::_syncError{0};        // static last PWM frame phase error
+#endif
+#ifdef SMOOTHLED_TRACE
+traceEntry smoothLED::_trace[TRACE_SIZE];     // static ring buffer of trace events
+uint8_t    smoothLED::_traceHead{0};          // static index of the next trace event
+bool       smoothLED::_traceWrapped{false};   // static flag that the trace has wrapped around
+#ifdef SMOOTHLED_MODERN_AVR
+uint16_t smoothLED::_traceOverflows{0};  // static TCA0 underflows for the trace timestamps
+#endif
+#endif
+#ifdef MASTER_BRIGHTNESS_ACTIVE
+uint8_t smoothLED::_masterLevel{255};  // static master brightness, 100% by default
+#endif
 
 smoothLED::smoothLED() {
   /*!
@@ -46,11 +207,6 @@ smoothLED::~smoothLED() {
   */
   uint8_t originalSREG = SREG;               // Save original SREG value before disabling interrupts
   cli();                                     // disable interrupts while changing registers
-  while (_nextSet != nullptr) {              // free up any stored "set()" actions
-    setStructure *tempPtr = _nextSet;        // Save current address
-    _nextSet              = _nextSet->next;  // point to next element in list
-    delete tempPtr;                          // free up storage
-  }                                          // while we have stored actions remove
   if (this == _firstLink) {                  // remove interrupts if this is the last instance
     fadeTimerOff;                            // disable fade timer
     pwmTimerOff;                             // disable PWM timer
@@ -124,12 +280,54 @@ smoothLED &smoothLED::operator-=(const int16_t &value) {
   pwmTimerOn;    // turn on PWM interrupt
   return *this;  // Return new class value
 }
+#ifdef SMOOTHLED_MODERN_AVR
+ISR(TCA0_LUNF_vect) {
+  /*!
+    @brief   Interrupt vector for the TCA0 low byte underflow
+    @details Indirect call to the faderISR() which performs fading every millisecond, after the
+             tick callbacks attached with "smoothLEDTick::attach()". The underflow rate depends on
+             the core and F_CPU, so "faderTicks()" returns the number of whole milliseconds that are
+             due. The callbacks are called at most once per interrupt, only "faderISR()" is repeated
+             when a sync slave runs an extra tick to follow the master or when more than one
+             millisecond is due, see "syncTicks()". The interrupt flag isn't cleared by hardware on
+             these processors
+  */
+  TCA0.SPLIT.INTFLAGS = TCA_SPLIT_LUNF_bm;    // clear the interrupt flag
+  uint8_t ticks = smoothLED::faderTicks();    // whole milliseconds due, usually 0 or 1
+  if (ticks != 0) smoothLEDTick::tickISR();   // call the attached callbacks once
+#ifdef FRAME_SYNC_ACTIVE
+  ticks = smoothLED::syncTicks(ticks);        // a sync slave runs 0 to 2 ticks
+#endif
+  for (; ticks != 0; --ticks) {               // for each tick
+    smoothLED::faderISR();                    // call the actual handler
+  }                                           // for-next each tick
+}  // ISR "TCA0_LUNF_vect()"
+ISR(SMOOTHLED_TCB_vect) {
+  /*!
+    @brief   Interrupt vector for the TCB used for software PWM
+    @details Indirect call to the pwmISR() which is called frequently to perform software PWM. The
+             interrupt flag isn't cleared by hardware on these processors
+  */
+  SMOOTHLED_TCB.INTFLAGS = TCB_CAPT_bm;  // clear the interrupt flag
+  smoothLED::pwmISR();                   // call the actual handler
+}  // ISR "SMOOTHLED_TCB_vect()"
+#else
 ISR(TIMER0_COMPA_vect) {
   /*!
     @brief   Interrupt vector for TIMER0_COMPA
-    @details Indirect call to the faderISR() which performs fading every millisecond
+    @details Indirect call to the faderISR() which performs fading every millisecond, after the
+             tick callbacks attached with "smoothLEDTick::attach()". The callbacks are called once
+             per interrupt, a sync slave runs "faderISR()" an extra time or skips it to follow the
+             master, see "syncTicks()"
   */
-  smoothLED::faderISR();  // call the actual handler
+  smoothLEDTick::tickISR();  // call the attached callbacks
+#ifdef FRAME_SYNC_ACTIVE
+  for (uint8_t n = smoothLED::syncTicks(); n != 0; --n) {  // a sync slave runs 0 to 2 ticks
+    smoothLED::faderISR();                                 // call the actual handler
+  }                                                        // for-next each tick
+#else
+  smoothLED::faderISR();  // and the actual handler
+#endif
 }  // ISR "TIMER0_COMPA_vect()"
 ISR(TIMER1_OVF_vect) {
   /*!
@@ -138,34 +336,65 @@ ISR(TIMER1_OVF_vect) {
   */
   smoothLED::pwmISR();  // call the actual handler
 }  // ISR "TIMER0_COMPA_vect()"
+#endif
 void smoothLED::pinOn() const {
   /*!
   @brief   Turn the LED to 100% on
   @details Since keeping PWM on and setting the register to the highest value doesn't actually
            result in a 100% duty cyle, this function turns on PWM and does a digital write to set
-           the pin to 1
+           the pin to 1. On the megaAVR 0-series and AVR-Dx processors this is a single write to the
+           OUTSET or OUTCLR register instead of a read-modify-write of the PORT register
   @return  void returns nothing
 */
+#ifdef SMOOTHLED_MODERN_AVR
+  *(_portRegister + ((_flags & INVERT_LED) ? PORT_OUTCLR : PORT_OUTSET)) = _registerBitMask;
+#else
   if (_flags & INVERT_LED) {
     *_portRegister &= ~_registerBitMask;
   } else {
     *_portRegister |= _registerBitMask;
   }  // if-then-else _inverted
+#endif
 }  // of function "pinOn()"
 void smoothLED::pinOff() const {
   /*!
     @brief   Turn the LED off
     @details Since keeping PWM on and setting the register to the lowest value doesn't actually
              result in the LED being completely off, this function turns off PWM and does a digital
-             write to set  the pin to 0
+             write to set  the pin to 0, see "pinOn()"
     @return  void returns nothing
   */
+#ifdef SMOOTHLED_MODERN_AVR
+  *(_portRegister + ((_flags & INVERT_LED) ? PORT_OUTSET : PORT_OUTCLR)) = _registerBitMask;
+#else
   if (_flags & INVERT_LED) {
     *_portRegister |= _registerBitMask;
   } else {
     *_portRegister &= ~_registerBitMask;
   }  // if-then-else _inverted
+#endif
 }  // of function "pinOff()"
+#ifdef SMOOTHLED_MODERN_AVR
+uint8_t smoothLED::faderTicks() {
+  /*!
+    @brief   Returns the number of 1ms fader ticks that are due in this TCA0 underflow interrupt
+    @details The TCA0 underflow period "_faderStep", read from the timer setup in "begin()", is
+             added to "_faderPhase" and a tick is due for every FADER_PHASE collected. So the ticks
+             average exactly 1ms whatever the TCA0 rate is, with a jitter of one underflow period
+    @return  uint8_t number of ticks, 0 or 1 while TCA0 underflows at least once per millisecond
+  */
+  uint8_t ticks{0};
+#ifdef SMOOTHLED_TRACE
+  ++_traceOverflows;                     // TCA0 periods for the trace timestamps
+#endif
+  _faderPhase += _faderStep;             // time since the last interrupt
+  while (_faderPhase >= FADER_PHASE) {  // for each whole millisecond
+    _faderPhase -= FADER_PHASE;         // collected
+    ++ticks;                            // run a tick
+  }                                     // of while loop for each millisecond
+  return ticks;
+}  // of function "faderTicks()"
+#endif
 void smoothLED::pwmISR() {
   /*!
   @brief     Function to actually perform software PWM on all pins
@@ -179,22 +408,43 @@ void smoothLED::pwmISR() {
              pin ON or OFF for the appropriate number of cycles.
              When no pins have active software PWM (values "OFF" and "ON" turn off PWM), then this
              interrupt is disabled until needed to minimize impact.
+             The "smoothLEDT" instances are skipped in the loop, each of their types in use does
+             the step for all of its LEDs with one call.
   */
-  smoothLED *p = _firstLink;                // Local pointer set to start of linked list
-  while (p != nullptr) {                    // Loop through linked list until end is reached
-    if (p->_portRegister != nullptr &&      // Skip processing if the pin is not initialized,
-        (p->_flags & SOFTWARE_MODE)) {      // or isn't performing software PWM
-      if (p->_currentCIE == _counterPWM) {  // If we've reached the PWM counter threshold
-        p->pinOff();                        // then turn pin off
-      } else {                              // otherwise
-        if (_counterPWM == 0) {             // if we've rolled over and are at the beginning,
-          p->pinOn();                       // turn the pin on
-        }                                   // if-then turn ON LED
-      }                                     // if-then-else turn off LED
-    }                                       // if then a valid pin
-    p = p->_nextLink;                       // go to next class instance
-  }                                         // of while loop to traverse  list
-  ++_counterPWM;                            // Pre-increment, overflows from 255 back to 0
+  if (_counterPWM == 0) traceEvent(TRACE_FRAME, 0, 0);  // Start of a new PWM frame
+  smoothLED *p = _firstLink;                   // Local pointer set to start of linked list
+  while (p != nullptr) {                       // Loop through linked list until end is reached
+    if (p->_portRegister != nullptr &&         // Skip processing if the pin is not initialized,
+        (p->_flags & (SOFTWARE_MODE | TEMPLATE_LED)) ==  // isn't performing software PWM or
+            SOFTWARE_MODE) {                   // it is done by a "smoothLEDT" type
+      if (p->_currentCIE == _counterPWM) {     // If we've reached the PWM counter threshold
+        p->pinOff();                           // then turn pin off
+      } else {                                 // otherwise
+        if (_counterPWM == 0) {                // if we've rolled over and are at the beginning,
+          p->pinOn();                          // turn the pin on
+        }                                      // if-then turn ON LED
+      }                                        // if-then-else turn off LED
+    }                                          // if then a valid pin
+    p = p->_nextLink;                          // go to next class instance
+  }                                            // of while loop to traverse  list
+  for (ledGroup *g = _firstGroup; g != nullptr; g = g->next) {  // For each "smoothLEDT" type
+    if (g->pwmStep != nullptr) g->pwmStep();                     // with software PWM do a step
+  }                                                              // for-next each type
+#ifdef FRAME_SYNC_ACTIVE
+  if (_syncPort != nullptr) {                  // When sync master, output the frame pulse
+#ifdef SMOOTHLED_MODERN_AVR
+    if (_counterPWM == 0) *(_syncPort + PORT_OUTSET) = _syncMask;
+    if (_counterPWM == SYNC_PULSE) *(_syncPort + PORT_OUTCLR) = _syncMask;
+#else
+    if (_counterPWM == 0) *_syncPort |= _syncMask;
+    if (_counterPWM == SYNC_PULSE) *_syncPort &= ~_syncMask;
+#endif
+  }                                            // if-then sync master
+#endif
+  ++_counterPWM;                               // Pre-increment, overflows from 255 back to 0
+#ifdef SMOOTHLED_TRACE
+  if (pwmPending) traceEvent(TRACE_OVERRUN, 0, 0);  // Next interrupt is already due
+#endif
 }  // of function "pwmISR()"
 bool smoothLED::begin(const uint8_t pin, const uint8_t flags) {
   /*!
@@ -243,7 +493,10 @@ bool smoothLED::begin(const uint8_t pin, const uint8_t flags) {
      ** an active fade in progress, otherwise it is disabled to save CPU cycles. Start off with   **
      ** the interrupt disabled until needed.                                                      **
      **********************************************************************************************/
-#if defined(TIMSK0)
+#if defined(SMOOTHLED_MODERN_AVR)
+    _faderStep = ((uint32_t)(TCA0.SPLIT.LPER + 1) * tcaPrescaler()) >> 4;  // in 16 CPU cycles
+    fadeTimerOff;  // TCA0 is setup by the Arduino core, only the interrupt is used
+#elif defined(TIMSK0)
     fadeTimerOff;
 #else
 #error Register TIMSK0 is not defined
@@ -259,7 +512,12 @@ bool smoothLED::begin(const uint8_t pin, const uint8_t flags) {
     ** This interrupt is turned off when there are no pins requiring software PWM. A non-PWM pin  **
     ** set to "OFF" (0) or "ON" (255) does not require PWM.                                       **
     ***********************************************************************************************/
-#if defined(OCR1AL) && defined(TIMSK1)
+#if defined(SMOOTHLED_MODERN_AVR)
+    pwmTimerOff;                                                  // Disable interrupt until needed
+    SMOOTHLED_TCB.CTRLB = TCB_CNTMODE_INT_gc;                     // Periodic interrupt mode,
+    SMOOTHLED_TCB.CCMP  = 1023;                                   // every 1024 clock cycles
+    SMOOTHLED_TCB.CTRLA = TCB_CLKSEL_CLKDIV1_gc | TCB_ENABLE_bm;  // with no pre-scaling
+#elif defined(OCR1AL) && defined(TIMSK1)
     pwmTimerOff;        // Disable the interrupt on TIMER1 Overflow until we need it
     sbi(TCCR1B, CS10);  // Set 3 "Clock Select" bits to no pre-scaling
     cbi(TCCR1B, CS11);
@@ -273,6 +531,9 @@ bool smoothLED::begin(const uint8_t pin, const uint8_t flags) {
 #endif
   }                                       // if-then first begin() call
   _timerPWMPin = digitalPinToTimer(pin);  // Get timer register for pin
+#ifdef SMOOTHLED_MODERN_AVR
+  if (_timerPWMPin != TIMERA0) _timerPWMPin = NOT_ON_TIMER;  // Only TCA0 pins use hardware PWM
+#endif
   if (_timerPWMPin != NOT_ON_TIMER) {     // If on a TIMER, then set up
     if (!(_flags & SOFTWARE_MODE)) {      // unless in software mode
       switchHardwarePWM(true);            // set PWM hardware mode
@@ -285,6 +546,15 @@ bool smoothLED::begin(const uint8_t pin, const uint8_t flags) {
        ** 16-bit timers to operate in 8-bit mode so no changes are made to the WGM and CS mode    **
        ** registers since it is assumed that the registers are setup correctly.                   **
        ********************************************************************************************/
+#ifdef SMOOTHLED_MODERN_AVR
+      /*********************************************************************************************
+      ** TCA0 in split mode has the 8-bit compare registers LCMP0, HCMP0, LCMP1, HCMP1, LCMP2     **
+      ** and HCMP2 in that order. The outputs WO0 to WO5 are pins 0 to 5 of the port TCA0 is      **
+      ** routed to, WO0-WO2 use the low byte registers and WO3-WO5 the high byte registers        **
+      *********************************************************************************************/
+      uint8_t channel = digitalPinToBitPosition(pin);  // WOn output of TCA0
+      _PWMRegister    = &TCA0.SPLIT.LCMP0 + (channel < 3 ? channel * 2 : (channel - 3) * 2 + 1);
+#endif
       switch (_timerPWMPin) {
 #if defined(TCCR0) && defined(COM00) && !defined(__AVR_ATmega8__)
         case TIMER0A:  // connect pwm to pin on timer 0
@@ -404,6 +674,7 @@ bool smoothLED::begin(const uint8_t pin, const uint8_t flags) {
   }                            // if-then-else hardware PWM pin
   volatile uint8_t *ddr = portModeRegister(digitalPinToPort(pin));  // get DDRn port for pin
   *ddr |= _registerBitMask;                                         // make the pin an output
+  _refreshAll = true;                                               // output is set in next tick
   set(0);                                                           // Turn off to start with
   SREG = originalSREG;                                              // Restore registers
   return true;                                                      // Return success
@@ -422,6 +693,18 @@ void smoothLED::switchHardwarePWM(const bool state) {
     _flags |= SOFTWARE_MODE;           // set the flag to software mode
     return;                            // and return
   } else {
+#ifdef SMOOTHLED_MODERN_AVR
+    /***********************************************************************************************
+    ** The enable bits in TCA0.SPLIT.CTRLB are LCMP0EN-LCMP2EN in bits 0-2 for WO0-WO2 and        **
+    ** HCMP0EN-HCMP2EN in bits 4-6 for WO3-WO5, so the bit is computed from the pin's bit mask    **
+    ***********************************************************************************************/
+    uint8_t enable = (_registerBitMask & 0x07) ? _registerBitMask : _registerBitMask << 1;
+    if (state && !(_flags & SOFTWARE_MODE)) {  // if ON and not in software mode
+      TCA0.SPLIT.CTRLB |= enable;              // connect the channel to the pin
+    } else {                                   // otherwise
+      TCA0.SPLIT.CTRLB &= ~enable;             // disconnect it
+    }                                          // if-then-else ON
+#else
     if (state && !(_flags & SOFTWARE_MODE)) {  // if ON and not in software mode
       switch (_timerPWMPin) {
 #if defined(TCCR0) && defined(COM00) && !defined(__AVR_ATmega8__)
@@ -631,211 +914,644 @@ void smoothLED::switchHardwarePWM(const bool state) {
 #endif
       }  // of switch
     }    // if ON or OFF mode
-  }      // if-then-else not a PWM pin
+#endif
+  }  // if-then-else not a PWM pin
 }  // of function "hardwarePWM()"
-void smoothLED::set(const uint8_t val, const uint16_t speed, const uint16_t delay) { /*!
+uint16_t smoothLED::fadeDelays(const uint8_t from, const uint8_t to, const uint16_t speed) {
+  /*!
+   @brief     Computes the fade rate for a change from one level to another
+   @details   This is done when a command is given, in the main program context, so that the 32-bit
+              division isn't performed inside "faderISR()" when a stacked command is started.
+              Compute the value from the delta between the levels and the speed value. Since the
+              interrupt is called 1000 times a second we compute "speed/delta" and multiply by 128
+              so that we don't need to use floating point. Each interrupt "_changeTicker" is
+              decremented by 128 and when it gets to 0 a fade step is applied and the value is added
+              back. So if a delta is 250 and the speed 500 then "500 * 128 / 250" = 256 and a fade
+              step is done every 2 calls to the interrupt. When both levels are the same the rate
+              of a single step is returned, so that "rescaleDelays()" can still use the speed if the
+              fade ends up starting from another level.
+   @param[in] from  The level the fade starts from
+   @param[in] to    The level the fade ends at
+   @param[in] speed The rate of change in milliseconds.
+   @return    uint16_t value for "_changeDelays", or 0 when the change is immediate
+ */
+  if (speed == 0) return 0;                              // the change is immediate
+  uint8_t  delta = (from > to) ? from - to : to - from;  // number of fade steps
+  if (delta == 0) delta = 1;                             // keep the speed for a single step
+  uint32_t temp  = ((uint32_t)speed << 7) / delta;       // compute the delay factor, see above
+  if (temp > UINT16_MAX) {                               // if the value is bigger than fits
+    temp = UINT16_MAX;                                   // clamp it to range,
+  } else if (temp < 128) {                               // and if it is less than minimum
+    temp = 128;                                          // then set it to minimum
+  }                                                      // if-then-else out of range
+  return static_cast<uint16_t>(temp);                    // return value, knowing it is in range
+}  // of function "fadeDelays()"
+uint16_t smoothLED::rescaleDelays(const uint16_t delays, const uint8_t from, const uint8_t level,
+                                  const uint8_t to) {
+  /*!
+   @brief     Adapts a fade rate to another start level, keeping the fade time
+   @details   A stacked command's rate is computed by "fadeDelays()" from the level the LED is
+              expected to have when the command starts. An effect or a crossfade can leave the LED
+              at another level, then "releaseLevel()" calls this function in the main program
+              context so that the fade still takes the requested time. The division is only needed
+              in that case.
+   @param[in] delays The fade rate as returned by "fadeDelays()"
+   @param[in] from   The level the rate was computed for
+   @param[in] level  The level the fade actually starts from
+   @param[in] to     The level the fade ends at
+   @return    uint16_t value for "_changeDelays"
+ */
+  uint8_t planned = (from > to) ? from - to : to - from;     // fade steps the rate is for
+  uint8_t actual  = (level > to) ? level - to : to - level;  // fade steps to do
+  if (planned == 0) planned = 1;                             // see "fadeDelays()"
+  if (delays == 0 || actual == 0) return delays;             // nothing to adapt
+  uint32_t temp = (uint32_t)delays * planned / actual;       // same time for the actual steps
+  if (temp > UINT16_MAX) {                                   // if the value is bigger than fits
+    temp = UINT16_MAX;                                       // clamp it to range,
+  } else if (temp < 128) {                                   // and if it is less than minimum
+    temp = 128;                                              // then set it to minimum
+  }                                                          // if-then-else out of range
+  return static_cast<uint16_t>(temp);                        // return value, knowing it's in range
+}  // of function "rescaleDelays()"
+void smoothLED::startFade(const uint8_t val, const uint16_t delays, const uint16_t delay) {
+  /*!
+   @brief     Starts a new fade or immediate change
+   @details   This private function is called from "faderISR()" when the next stacked command is
+              due. The fade rate has already been computed by "fadeDelays()" so only constant-time
+              loads are done.
+   @param[in] val    The value 0-255 to set the LED
+   @param[in] delays The fade rate as returned by "fadeDelays()", 0 for an immediate change
+   @param[in] delay  The delay in milliseconds after reaching target
+ */
+  _targetLevel = val;        // set new target (regardless of mode),
+  _waitTime    = delay;      // and set the post-fade delay time
+  if (delays == 0) {         // Set a value directly and immediately
+    _currentLevel = val;     // set current to value to force an immediate set
+  } else {                   // otherwise fade at the precomputed rate
+    _changeDelays = delays;  // set the rate,
+    _changeTicker = delays;  // and the first step is one full period from now
+  }                          // if-then-else immediate change or fading
+  pwmTimerOn;                // turn on PWM interrupt
+}  // of function "startFade()"
+bool smoothLED::set(const uint8_t val, const uint16_t speed, const uint16_t delay) { /*!
    @brief     sets the LED
-   @details   This public function is called to set the instance variables used for software and
-              hardware PWM to the appropriate values. The actual setting of pin as well as the
-              software PWM fading is done in the "faderISR()" function.
+   @details   This public function is called to stack a command for the "faderISR()" function, which
+              does the actual setting of pin as well as the software PWM fading. If no command is
+              active then the "faderISR()" starts it in the next tick, this is also the case for an
+              immediate change with a speed of 0, so "getLevel()" returns the new level only after
+              the next tick.
+              The commands are stored in a ring buffer of SET_QUEUE_SIZE entries per LED, which is
+              only written to here and only read from in "faderISR()". The command is written to the
+              slot first and then published by incrementing the single-byte "_queueTail" index, so
+              interrupts never need to be disabled. When the ring is full the command is ignored and
+              false is returned.
+              A stacked command fades from the target level of the command before it, or from the
+              scene level when the LED is in a running crossfade, so the fade rate is computed here
+              rather than in the interrupt. When the LED starts the command from another level, e.g.
+              where an effect was stopped, the rate is adapted by "releaseLevel()" before the
+              command can start, so "faderISR()" only loads the precomputed rate.
    @param[in] val   The value 0-255 to set the LED. Defaults to 0 (OFF)
    @param[in] speed The rate of change in milliseconds.
    @param[in] delay The delay in milliseconds after reaching target
+   @return    bool  TRUE when the command was stacked, FALSE when the ring was full
  */
-  uint8_t originalSREG = SREG;  // Save original SREG value before disabling interrupts
-  cli();                        // disable interrupts while changing registers
-  /*************************************************************************************************
-   ** If there is no active fade going on (defined by current=target and no wait time), then      **
-   ** perform this set(); otherwise add it onto the list of actions and it will get executed once **
-   ** the current action is finished.                                                             **
-   ************************************************************************************************/
-  if (_currentLevel == _targetLevel && _waitTime == 0) {  // if no actions are active, then
-    _targetLevel = val;                                   // set new target (regardless of mode),
-    _waitTime    = delay;                                 // and set the post-fade delay time
-    /***********************************************************************************************
-    ** There are two distinct types of setup:                                                     **
-    ** 1. Immediate: When "speed" is 0, then immediately set the pin to the requested PWM value   **
-    ** 2. Fade:      When "speed" is nonzero, we fade from whatever the current setting is to the **
-    **               target value at a speed computed here.                                       **
-    ***********************************************************************************************/
-    if (speed == 0) {       // Set a value directly and immediately
-      _currentLevel = val;  // set current to value to force an immediate set
-    } else {                // otherwise we have a delta between actual and target
-      /*********************************************************************************************
-      ** Compute the "_changeDelays" value from the delta between current and target and the speed**
-      ** value. Since the interrupt is called 1000 times a second we compute "1000/delta" and     **
-      ** multiply by 128 so that we don't need to use floating point. This is what the variable   **
-      ** "_changeTicker" is set to and each interrupt this is decremented by 128 until it is 0 or **
-      ** less, then the fade is applied. So if a delta is 500 then "1000 * 128 / delta" = 256     **
-      ** (rounded to int). A fade is done done every 2 calls to the interrupt for this example.   **
-      *********************************************************************************************/
-      uint32_t temp = (_currentLevel > _targetLevel) ? _currentLevel - _targetLevel
-                                                     : _targetLevel - _currentLevel;
-      temp = ((uint32_t)speed << 7) / temp;         // compute the delay factor, see comments above
-      if (temp > UINT16_MAX) {                      // if the value is bigger than fits
-        temp = UINT16_MAX;                          // clamp it to range,
-      } else if (temp < 128) {                      // and if it is less than minimum
-        temp = 128;                                 // then set it to minimum
-      }                                             // if-then-else out of range
-      _changeDelays = static_cast<uint16_t>(temp);  // Set the value, knowing it is in range
-    }                                               // if-then-else immediate change or fading
-    fadeTimerOn;                                    // turn on fade interrupt
-    pwmTimerOn;                                     // turn on PWM interrupt
-  } else {
-    /***********************************************************************************************
-    ** Attempt to allocate space for storing the action, skip and ignore if unsuccessful          **
-    ***********************************************************************************************/
-    setStructure *p = new setStructure;
-    if (p != nullptr) {
-      p->changeSpeed = speed;
-      p->delayMS     = delay;
-      p->targetLevel = val;
-      p->next        = nullptr;
-      if (_nextSet == nullptr) {
-        _nextSet = p;  // this is the first element
-      } else {
-        setStructure *tmpPtr = _nextSet;  // start at beginning of list
-        while (tmpPtr->next != nullptr) {
-          tmpPtr = tmpPtr->next;
-        }                  // while go to end of list
-        tmpPtr->next = p;  // assign the next element to list
-      }                    // if-then first in list
-    }                      // if-then we can allocate space
-  }                        // if-then no active fade
-  SREG = originalSREG;     // Restore interrupts register
+  uint8_t tail = _queueTail;                       // only this function changes the tail
+  uint8_t head = _queueHead;                       // snapshot, "faderISR()" might change it
+  if ((uint8_t)(tail - head) >= SET_QUEUE_SIZE) {  // ignore when ring is full
+    traceEvent(TRACE_FULL, ledNumber(), val);      // and record the lost command
+    return false;
+  }                                                // if-then ring full
+  uint8_t from = _targetLevel;                     // fade from the current target,
+  if (_sceneActive && _inScene) from = _sceneTo;   // the end of the crossfade,
+  if (tail != head) from = _queue[(tail - 1) & (SET_QUEUE_SIZE - 1)].targetLevel;  // or last one
+  setStructure &slot = _queue[tail & (SET_QUEUE_SIZE - 1)];
+  slot.targetLevel   = val;
+  slot.fromLevel     = from;
+  slot.changeDelays  = fadeDelays(from, val, speed);
+  slot.delayMS       = delay;
+  memoryBarrier;                  // slot has to be written before it is published
+  _queueTail = tail + 1;          // publish the command
+  fadeTimerOn;                    // turn on fade interrupt
+  return true;
 }  // of function "set()"
 void smoothLED::setNow(const uint8_t val, const uint16_t speed, const uint16_t delay) {
   /*!
     @brief     sets the LED, and cancels any active or stored actions
     @details   This function is identical to "set()", but will override any active and stored
-               actions for the pin, unlike "set()".
+               actions for the pin, unlike "set()". The cancellation is done by storing the ring
+               index of the new command and incrementing "_cancelGeneration". When "faderISR()" sees
+               a new generation it ends the active action, moves the ring head to that index and
+               starts the new command, so the cost is constant regardless of what was stacked. The
+               cancellation is published before the slot is written so that "faderISR()" can never
+               start a partially written command, even if the ring was full. A running effect is
+               stopped as well and the LED no longer follows a running crossfade. This is done after
+               the cancellation, so "faderISR()" can't change the target level any more and the new
+               command fades from exactly there.
     @param[in] val   The value 0-255 to set the LED. Defaults to 0 (OFF)
     @param[in] speed The rate of change in milliseconds.
     @param[in] delay The delay in milliseconds after reaching target
  */
-  uint8_t originalSREG = SREG;               // Save original SREG value before disabling interrupts
-  cli();                                     // disable interrupts while changing registers
-  while (_nextSet != nullptr) {              // free up any stored "set()" actions
-    setStructure *tempPtr = _nextSet;        // Save current address
-    _nextSet              = _nextSet->next;  // point to next element in list
-    delete tempPtr;                          // free up storage
-  }                                          // while we have stored actions to remove
-  _currentLevel = _targetLevel;              // make equal for set() call to work
-  _waitTime     = 0;                         // set to zero for set() call to work
-  set(val, speed, delay);                    // and now call set()
-  SREG = originalSREG;                       // Restore register interrupts
+  uint8_t tail = _queueTail;   // only this function and "set()" change the tail
+  _cancelIndex = tail;         // everything before this index is discarded
+  ++_cancelGeneration;         // publish the cancellation,
+  memoryBarrier;               // so no stacked command can start
+  _effect.type = EFFECT_NONE;  // when the running effect is stopped
+  _inScene     = false;        // and the running crossfade is left,
+  memoryBarrier;               // which fixes the target level before the slot is written
+  setStructure &slot = _queue[tail & (SET_QUEUE_SIZE - 1)];
+  slot.targetLevel   = val;                                // the active action is ended at
+  slot.fromLevel     = _targetLevel;                       // its target, so fade from there
+  slot.changeDelays  = fadeDelays(slot.fromLevel, val, speed);
+  slot.delayMS       = delay;
+  memoryBarrier;                  // slot has to be written before it is published
+  _queueTail = tail + 1;          // publish the command
+  fadeTimerOn;                    // turn on fade interrupt
 }  // of function "setnow()"
+uint8_t smoothLED::getLevel() const {
+  /*!
+    @brief   Returns the current level of the LED
+    @details This is the level before the CIE conversion, so during a fade it is the value that the
+             "faderISR()" has reached so far
+    @return  uint8_t current level 0-255
+  */
+  return _currentLevel;
+}  // of function "getLevel()"
+bool smoothLED::isBusy() const {
+  /*!
+    @brief   Returns whether the LED still has work to do
+    @return  bool TRUE while fading, waiting after a fade, running an effect or crossfade or when
+             there are stacked commands
+  */
+  return _currentLevel != _targetLevel || _waitTime != 0 || _queueHead != _queueTail ||
+         _effect.type != EFFECT_NONE || (_sceneActive && _inScene);
+}  // of function "isBusy()"
+void smoothLED::setMaxLevel(const uint8_t level) {
+  /*!
+    @brief     Sets the maximum output level of the LED
+    @details   All levels of the LED are scaled by "level / 256" before the CIE table lookup, so a
+               fixture can be capped without changing the values used in "set()". Active fades and
+               stacked commands continue unchanged, the new scale is applied in the next tick. The
+               multiplication is only done in "faderISR()" when the LED's level has changed.
+    @param[in] level The output level 0-255 that a level of 255 is scaled to, 255 means 100%
+  */
+  _maxLevel = level;   // only read in "faderISR()",
+  memoryBarrier;       // so it has to be written before
+  _refreshAll = true;  // all outputs are recomputed in the next tick
+  fadeTimerOn;         // turn on fade interrupt
+  pwmTimerOn;          // turn on PWM interrupt, a scaled "ON" might need PWM
+}  // of function "setMaxLevel()"
+void smoothLED::setEffect(const uint8_t effect, const uint8_t base, const uint8_t amplitude,
+                          const uint8_t rate) {
+  /*!
+    @brief     Starts or stops an effect computed by "faderISR()"
+    @details   While an effect is running it sets the level of the LED and stacked commands wait.
+               Stopping it with EFFECT_NONE leaves the LED at its current level and continues with
+               the stacked commands, whose fade rates are adapted to that level by "releaseLevel()"
+               so that they still take the requested time. "setNow()" stops it as well. Starting an
+               effect takes the LED out of a running crossfade. The descriptor is only read by
+               "faderISR()" while the effect type isn't EFFECT_NONE, so the type is cleared while
+               the descriptor is written and then published last
+    @param[in] effect    EFFECT_CANDLE, EFFECT_STROBE, EFFECT_NOISE, EFFECT_HEARTBEAT or EFFECT_NONE
+    @param[in] base      The lowest level 0-255
+    @param[in] amplitude The level range above the base, the top level is limited to 255
+    @param[in] rate      Milliseconds between two updates, 1-255
+  */
+  if (effect == EFFECT_NONE) {  // When stopping the effect
+    releaseLevel();             // continue from its level
+    fadeTimerOn;                // with the stacked commands
+    return;
+  }                             // if-then stop
+  _effect.type = EFFECT_NONE;  // "faderISR()" ignores the descriptor now
+  _inScene     = false;        // the effect replaces a running crossfade
+  memoryBarrier;               // so it has to be written before
+  _effect.base      = base;    // the new values
+  _effect.amplitude = amplitude;
+  _effect.rate      = rate ? rate : 1;
+  _effect.ticker    = 1;       // first update in the next tick
+  _effect.phase     = 0;
+  memoryBarrier;               // descriptor has to be written before it is published
+  _effect.type = effect;       // publish the effect
+  fadeTimerOn;                 // turn on fade interrupt
+  pwmTimerOn;                  // turn on PWM interrupt
+}  // of function "setEffect()"
+void smoothLED::releaseLevel() {
+  /*!
+    @brief   Ends the effect and crossfade of the LED, the stacked commands continue from its level
+    @details While an effect or a crossfade sets the level the stacked commands wait, and the fade
+             rate of the first one was computed for the level expected when it was stacked. The rate
+             is adapted to the level reached with "rescaleDelays()" here in the main program
+             context, so that "faderISR()" never has to divide. Then the slot is written and the
+             effect and the crossfade are ended in one short critical section, but only if the level
+             hasn't been changed by "faderISR()" in the meantime, otherwise this is repeated.
+             Without an effect or crossfade the target level is the expected one and nothing is
+             adapted
+  */
+  bool done{false};
+  while (!done) {
+    uint8_t       level = _targetLevel;  // level to continue from
+    uint8_t       head  = _queueHead;    // first stacked command
+    setStructure &slot  = _queue[head & (SET_QUEUE_SIZE - 1)];
+    uint16_t      delays{slot.changeDelays};
+    bool          adapt = head != _queueTail && slot.fromLevel != level;  // rate for another level
+    if (adapt) delays = rescaleDelays(delays, slot.fromLevel, level, slot.targetLevel);
+    uint8_t originalSREG = SREG;  // Save original SREG value
+    cli();                        // disable interrupts while ending the effect
+    if (_targetLevel == level && _queueHead == head) {  // If nothing changed meanwhile
+      if (adapt) {                                      // then adapt the first command
+        slot.changeDelays = delays;
+        slot.fromLevel    = level;
+      }                                                 // if-then adapt
+      _effect.type = EFFECT_NONE;                       // and end the effect
+      _inScene     = false;                             // and crossfade
+      done         = true;
+    }                                                   // if-then unchanged
+    SREG = originalSREG;  // Restore interrupt state to original
+  }                       // while level changed meanwhile
+}  // of function "releaseLevel()"
+void smoothLED::runEffect(const uint8_t skipped) {
+  /*!
+    @brief     Updates the running effect, called from "faderISR()" once per run
+    @details   The ticks skipped while "faderISR()" was sleeping are subtracted from the ticker, the
+               sleep never extends past the next update. When an update is due a new level is
+               computed from the 16-bit xorshift random value and written to both the current and
+               target level, so the fading code in "faderISR()" has nothing to do for this LED.
+    @param[in] skipped Ticks skipped since the last run of "faderISR()"
+  */
+  if (_effect.ticker > skipped + 1) {  // If the next update isn't due yet
+    _effect.ticker -= skipped + 1;     // count down the ticks
+    return;                            // and return
+  }                                    // if-then not due
+  _effect.ticker = _effect.rate;       // next update
+  _random ^= _random << 7;             // xorshift16 with shifts 7, 9 and 8
+  _random ^= _random >> 9;
+  _random ^= _random << 8;
+  uint8_t  random = _random;           // low byte of the new random value
+  uint16_t level  = _effect.base;      // level range starts at the base
+  switch (_effect.type) {
+    case EFFECT_CANDLE:                // squared random value gives mostly small dips
+      level += _effect.amplitude - ((((uint16_t)random * random) >> 8) * _effect.amplitude >> 8);
+      level = (level + _currentLevel + 1) >> 1;  // smoothed with the previous level
+      break;
+    case EFFECT_STROBE:
+      _effect.phase ^= 1;              // alternate between base and top
+      if (_effect.phase) level += _effect.amplitude;
+      break;
+    case EFFECT_NOISE:
+      level += ((uint16_t)random * (_effect.amplitude + 1)) >> 8;
+      break;
+    case EFFECT_HEARTBEAT:
+      level += ((uint16_t)pgm_read_byte(kheartbeat + _effect.phase) * _effect.amplitude) >> 8;
+      _effect.phase = (_effect.phase + 1) & 15;  // 16 step envelope
+      break;
+  }                                    // of switch effect type
+  if (level > 255) level = 255;        // limit the top level
+  _targetLevel  = level;               // set both levels so that no fade is done
+  _currentLevel = level;
+  _waitTime     = 0;
+}  // of function "runEffect()"
+void smoothLED::crossfadeTo(const uint8_t *scene, const uint8_t count, const uint16_t ms) {
+  /*!
+    @brief     Fades the first "count" LEDs from their current levels to the levels of a scene
+    @details   The scene levels are copied to the LEDs while "faderISR()" ignores the crossfade,
+               then the stacked commands of these LEDs are discarded and the crossfade is published
+               in one short critical section, so every LED starts in the same tick from the level it
+               has reached. Their effects are stopped. The LEDs beyond "count" aren't read from the
+               scene and keep their level, effect and stacked commands, only a previous crossfade
+               that they were following ends for them with "releaseLevel()". "faderISR()" adds
+               "_sceneStep" to the shared progress in every tick, which is rounded up so that the
+               crossfade takes exactly "ms" ticks up to 4 seconds and is at most 0.4% shorter above
+               that. An array can be passed without a count, the template in the header uses its
+               size
+    @param[in] scene PROGMEM array with one level for each smoothLED instance, in order of
+                     declaration
+    @param[in] count Number of levels in the scene
+    @param[in] ms    The crossfade time in milliseconds, 0 for an immediate change
+  */
+  uint8_t    n{0};  // position of the LED in the scene
+  smoothLED *p = _firstLink;
+  while (p != nullptr) {                      // loop through all instances
+    if (n < count) {                          // the LEDs in the scene
+      ++n;                                    // get new levels,
+    } else if (p->_inScene) {                 // the others leave a running crossfade
+      p->releaseLevel();                      // and continue from their level
+    }                                         // if-then-else in the scene
+    p = p->_nextLink;
+  }  // of while loop to traverse list
+  _sceneActive = false;  // "faderISR()" ignores the scene levels now
+  memoryBarrier;         // so they have to be written after this
+  n = 0;
+  p = _firstLink;
+  while (p != nullptr) {                           // loop through all instances
+    if (n < count) {                               // If the LED is in the scene
+      p->_sceneTo     = pgm_read_byte(scene + n);  // then read its level,
+      p->_effect.type = EFFECT_NONE;               // stop any running effect
+      p->_inScene     = true;                      // and follow the crossfade
+      ++n;
+    } else {                                       // otherwise
+      p->_inScene = false;                         // leave it out
+    }                                              // if-then-else in the scene
+    p = p->_nextLink;
+  }  // of while loop to traverse list
+  _sceneStep = ms ? (SCENE_END + ms - 1) / ms : SCENE_END;  // progress per tick, rounded up
+  uint8_t originalSREG = SREG;  // Save original SREG value
+  cli();                        // one critical section for all LEDs
+  for (p = _firstLink; p != nullptr; p = p->_nextLink) {
+    if (p->_inScene) {                  // only for the LEDs in the scene
+      p->_cancelIndex = p->_queueTail;  // discard all stacked commands
+      ++p->_cancelGeneration;
+    }                   // if-then in the scene
+  }                     // for-next each LED
+  _sceneStart  = true;  // publish the crossfade
+  _sceneActive = true;
+  SREG         = originalSREG;  // Restore interrupt state to original
+  fadeTimerOn;                  // turn on fade interrupt
+  pwmTimerOn;                   // turn on PWM interrupt
+}  // of function "crossfadeTo()"
+void smoothLED::runScene(const uint16_t mix) {
+  /*!
+    @brief     Sets the level of an LED following the crossfade, called from "faderISR()"
+    @details   The level is interpolated between "_sceneFrom" and "_sceneTo" and written to both the
+               current and target level, like an effect, so the fading code has nothing to do
+    @param[in] mix Progress of the crossfade, 0 at the start level up to 256 at the scene level
+  */
+  uint8_t level;
+  if (_sceneTo >= _sceneFrom) {  // brighten or fade with an unsigned 8x8 bit multiplication
+    level = _sceneFrom + (((uint16_t)(_sceneTo - _sceneFrom) * mix) >> 8);
+  } else {
+    level = _sceneFrom - (((uint16_t)(_sceneFrom - _sceneTo) * mix) >> 8);
+  }  // if-then-else brighten
+  _targetLevel  = level;
+  _currentLevel = level;
+  _waitTime     = 0;
+}  // of function "runScene()"
+#ifdef MASTER_BRIGHTNESS_ACTIVE
+void smoothLED::setMasterBrightness(const uint8_t level) {
+  /*!
+    @brief     Sets the master brightness for all LEDs
+    @details   The levels of all LEDs are scaled by "(level + 1) / 256" before the per-LED scaling
+               and the CIE table lookup, so a master brightness of 255 leaves every level unchanged.
+               Active fades and stacked commands continue unchanged and all LEDs are updated in the
+               next tick.
+    @param[in] level Master brightness 0-255, where 255 is 100%
+  */
+  if (level == _masterLevel) return;  // outputs are already correct
+  _masterLevel = level;               // store new value, it has to be written
+  memoryBarrier;                      // before all outputs
+  _refreshAll = true;                 // are recomputed in the next tick
+  fadeTimerOn;                        // turn on fade interrupt
+  pwmTimerOn;                         // turn on PWM interrupt, a scaled "ON" might need PWM
+}  // of function "setMasterBrightness()"
+#endif
+uint8_t smoothLED::scaledLevel() const {
+  /*!
+    @brief   Returns the current level after the master brightness and per-LED scaling
+    @details Called from "faderISR()" only when the level or one of the scales has changed
+    @return  uint8_t scaled level 0-255
+  */
+  uint8_t level = _currentLevel;
+#ifdef MASTER_BRIGHTNESS_ACTIVE
+  if (_masterLevel != 255) {                                        // if all LEDs are dimmed,
+    level = ((uint16_t)level * ((uint16_t)_masterLevel + 1)) >> 8;  // scale by the master
+  }                                                                 // if-then master dimmed
+#endif
+  if (_maxLevel != 255) {                                        // if this LED is capped,
+    level = ((uint16_t)level * ((uint16_t)_maxLevel + 1)) >> 8;  // scale it
+  }                                                              // if-then LED capped
+  return level;
+}  // of function "scaledLevel()"
+void smoothLED::updateOutput() {
+  /*!
+    @brief   Sets the CIE value and the pin or PWM register for the current level
+    @details Called from "faderISR()" only when the level or one of the scales has changed
+  */
+  uint8_t level = scaledLevel();  // level after master brightness and per-LED scale
+  /*************************************************************************************************
+  ** Compute the CIE or use the value directly if CIE is turned off                               **
+  *************************************************************************************************/
+#ifdef CIE_MODE_ACTIVE
+  if (_flags & NO_CIE_MODE) {
+    _currentCIE = level;
+  } else {
+    _currentCIE = pgm_read_word(kcie + level);
+  }  // if-then no CIE
+#else
+  _currentCIE = level;
+#endif
+  /*************************************************************************************************
+  ** If the pin is set to "ON" or "OFF", then turn off PWM and explicitly set the pin to the      **
+  ** state requested                                                                              **
+  *************************************************************************************************/
+  if (level == 0 || level == 255) {  // if value is ON or OFF
+    _flags &= ~PWM_ACTIVE;           // turn off PWM flag
+    switchHardwarePWM(false);        // turn off PWM mode if HW PWM
+    if (level == 0) {
+      pinOff();
+    } else {
+      pinOn();
+    }  // if-then turn "OFF" or "ON"
+  } else {
+    _flags |= PWM_ACTIVE;  // turn on PWM flag
+    /***********************************************************************************************
+    ** If we have a PWM value and we are in hardware mode, then actually set the register to the  **
+    ** PWM value. If we are in software mode, then do nothing, the toggling is handled by the     **
+    ** interrupt handler "pwmISR()".                                                              **
+    ***********************************************************************************************/
+    if (!(_flags & SOFTWARE_MODE)) {  // If we are in hardware PWM mode
+      switchHardwarePWM(true);        // turn on PWM mode if using HW pin
+      if (_flags & INVERT_LED) {      // Set depending upon inverted flag state
+        if (_flags & TIMER1_PIN) {    // TIMER1 pins are 10 bit and re-casting and shifting
+          *(volatile uint16_t *)_PWMRegister = ((uint16_t)(255) - _currentCIE) << 2;
+        } else {
+          *_PWMRegister = 255 - _currentCIE;
+        }  // if-then TIMER1 pin
+      } else {
+        if (_flags & TIMER1_PIN) {  // TIMER1 pins are 10 bit and re-casting and shifting
+          *(volatile uint16_t *)_PWMRegister = (uint16_t)_currentCIE << 2;
+        } else {
+          *_PWMRegister = _currentCIE;
+        }  // if-then TIMER1 pin
+      }    // if-then inverted
+    }      // if-then hardware PWM
+  }        // if-then-else "ON" or "OFF"
+}  // of function "updateOutput()"
 void smoothLED::faderISR() {
   /*!
     @brief   Performs fading PWM functions
     @details While the "pwmISR()" is called via TIMER0_COMPA_vect every millisecond, since we are
              piggybacking off the standard TIMER0 settings which are used by the Arduino IDE for the
              millis() timing function.
+             Slow fades and long waits change nothing for most ticks, so at the end of each run the
+             number of ticks until the next level change, end of a wait or stacked command of any
+             LED is stored in "_sleepTicks". Those ticks only decrement the counter and return, and
+             the next full run first applies all of the skipped ticks to each LED in one step, so
+             the fade timing is unchanged. "set()", "setNow()" and the operators clear the counter
+             so that a new command is always handled in the next tick.
+             LEDs running an effect get their level from "runEffect()", their stacked commands wait
+             until the effect is stopped. The same is done by "runScene()" for the LEDs following a
+             crossfade, with one progress value for all of them that is advanced here.
+             The output of a "smoothLEDT" instance is only marked with OUTPUT_DUE in the loop, and
+             set by its type after the loop.
   */
-  bool turnPWMoff{true};   // set to false when any pin has software PWM
-  bool turnFadeOff{true};  // set to false when any pin is fading
+  if (_sleepTicks != 0) {  // If nothing is due in this tick
+    --_sleepTicks;         // then count it down,
+    ++_skippedTicks;       // remember it for the catch-up
+    return;                // and return immediately
+  }                        // if-then sleeping
+  uint8_t skipped = _skippedTicks;  // Ticks to catch up on in this run
+  _skippedTicks   = 0;              // reset for the next sleep
+  bool    refresh = _refreshAll;    // Recompute all outputs in this run
+  _refreshAll     = false;          // only once
+  uint8_t sleep{UINT8_MAX};         // lowest number of ticks until something is due
+  bool    turnPWMoff{true};         // set to false when any pin has software PWM
+  bool    turnFadeOff{true};        // set to false when any pin is fading
+  bool    outputDue{false};         // set when a "smoothLEDT" output has to be set
+  bool     scene = _sceneActive;  // LEDs in the crossfade are set in this run
+  bool     start{false};          // and get their start level
+  uint16_t mix{0};                // crossfade progress, 0-256
+  if (scene) {                    // Advance the shared crossfade progress
+    start = _sceneStart;
+    if (start) {                  // first tick of a new crossfade
+      _sceneStart    = false;
+      _sceneProgress = _sceneStep;
+    } else {
+      _sceneProgress += _sceneStep;
+    }                                    // if-then-else first tick
+    if (_sceneProgress >= SCENE_END) {  // the last tick sets the scene levels
+      mix          = 256;
+      _sceneActive = false;
+    } else {
+      mix = _sceneProgress >> 16;
+    }  // if-then-else complete
+  }    // if-then crossfade
+  traceEvent(TRACE_FADER, 0, skipped);  // Start of a full run
+#ifdef SMOOTHLED_TRACE
+  uint8_t led{0};  // position of the LED in the list for the trace events
+#endif
   /*************************************************************************************************
   ** Traverse the whole linked list, checking each LED pin to see if we need to do something      **
   *************************************************************************************************/
   smoothLED *p = _firstLink;            // set ptr to first link for loop
   while (p != nullptr) {                // loop through all class instances
     if (p->_portRegister != nullptr) {  // Skip processing if the pin is not initialized
+      uint8_t previous = p->_currentLevel;  // Level before this tick
+      if (start) p->_sceneFrom = previous;  // A new crossfade starts at the current level
+      /*********************************************************************************************
+      ** If "setNow()" has been called since the last tick, then end the active action at its     **
+      ** target and discard all commands stacked before the new one                               **
+      *********************************************************************************************/
+      if (p->_cancelGeneration != p->_seenGeneration) {  // "setNow()" was called
+        p->_seenGeneration = p->_cancelGeneration;       // only do this once
+        p->_queueHead      = p->_cancelIndex;            // discard stacked commands
+        p->_currentLevel   = p->_targetLevel;            // end active fade,
+        p->_waitTime       = 0;                          // and active wait
+        traceEvent(TRACE_CANCEL, led, p->_targetLevel);
+      }                                                  // if-then cancel
+      if (p->_effect.type != EFFECT_NONE) p->runEffect(skipped);  // Effect sets the levels
+      if (scene && p->_inScene) p->runScene(mix);                 // as does a crossfade
+      /*********************************************************************************************
+      ** Apply the ticks skipped while sleeping. No fade step or end of wait was due in those, so **
+      ** they only count down the ticker or the wait time                                         **
+      *********************************************************************************************/
+      uint16_t elapsed = (uint16_t)skipped << 7;  // ticker decrement for the skipped ticks
+      if (p->_currentLevel != p->_targetLevel) {  // When fading, the ticker stayed above 0
+        if (p->_changeTicker > elapsed) {         // for all skipped ticks, unless the target
+          p->_changeTicker -= elapsed;            // was changed by an operator while sleeping
+        } else {                                  // in which case the
+          p->_changeTicker = 0;                   // step is due now
+        }                                         // if-then-else ticker in range
+      } else if (p->_waitTime) {                  // When waiting, the wait time stayed
+        p->_waitTime -= skipped;                  // above 0 for all skipped ticks
+      }                                           // if-then-else fading or waiting
       /*********************************************************************************************
       ** If the pin hasn't reached the target level, then perform the dynamic PWM change at the   **
       ** appropriate speed                                                                        **
       *********************************************************************************************/
-      if (p->_currentLevel != p->_targetLevel) {     // Perform the fade
-        turnFadeOff = false;                         // Fading still active
-        p->_changeTicker -= 128;                     // decrement the ticker
-        if (p->_changeTicker <= 0) {                 // When ticker goes to zero
-          p->_changeTicker += p->_changeDelays;      // add delay factor to ticker for new value
-          if (p->_currentLevel > p->_targetLevel) {  // choose direction
-            --p->_currentLevel;                      // current > target
-          } else {                                   // otherwise
-            ++p->_currentLevel;                      // current < target
-          }                                          // if-then-else get dimmer
-        }                                            // if-then  change current value
-      } else {                                       // otherwise we have current = target, so
-        if (p->_waitTime) {                          // and if we have a wait time then
-          --p->_waitTime;                            // decrement it and make sure to mark
-          turnFadeOff = false;                       // the fading status as still active
-        } else {
-          /*****************************************************************************************
-          ** If we've reached the target setting and have no wait cycles, then check to see if    **
-          ** there is a another set() command on the stack. If so, we pop it off the stack and    **
-          ** set the values to the cached command                                                 **
-          *****************************************************************************************/
-          if (p->_nextSet != nullptr) {
-            turnFadeOff          = false;        // switch flag off
-            setStructure *tmpPtr = p->_nextSet;  // point to beginning
-            p->set(tmpPtr->targetLevel, tmpPtr->changeSpeed, tmpPtr->delayMS);  // set new values
-            p->_nextSet = p->_nextSet->next;  // link to next one in list
-            delete tmpPtr;                    // free up the space in linked list
-            break;                            // leave loop
-          }                                   // if-then we have another set command
-        }                                     // if-then-else waitTime is nonzero
-      }                                       // if-then-else no change in PWM
+      if (p->_currentLevel != p->_targetLevel) {       // Perform the fade
+        turnFadeOff = false;                           // Fading still active
+        if (p->_changeTicker > 128) {                  // When ticker hasn't reached zero
+          p->_changeTicker -= 128;                     // decrement the ticker
+        } else {                                       // otherwise
+          p->_changeTicker += p->_changeDelays - 128;  // add delay factor for new value
+          if (p->_currentLevel > p->_targetLevel) {    // choose direction
+            --p->_currentLevel;                        // current > target
+          } else {                                     // otherwise
+            ++p->_currentLevel;                        // current < target
+          }                                            // if-then-else get dimmer
+          traceEvent(TRACE_STEP, led, p->_currentLevel);
+        }                                              // if-then-else change current value
+      } else if (p->_waitTime) {                       // otherwise if we have a wait time then
+        --p->_waitTime;                                // decrement it and make sure to mark
+        turnFadeOff = false;                           // the fading status as still active
+      }                                                // if-then-else fading or waiting
       /*********************************************************************************************
-      ** Compute the CIE or use the value directly if CIE is turned off                           **
+      ** If we've reached the target setting and have no wait cycles, then check to see if there  **
+      ** is a another set() command on the stack. If so, we pop it off the front of the ring and  **
+      ** start it in this tick so that the stacked commands follow each other without a gap. The  **
+      ** loop continues so all of the following LEDs get their tick.                              **
       *********************************************************************************************/
-#ifdef CIE_MODE_ACTIVE
-      if (p->_flags & NO_CIE_MODE) {
-        p->_currentCIE = p->_currentLevel;
-      } else {
-        p->_currentCIE = pgm_read_word(kcie + p->_currentLevel);
-      }  // if-then no CIE
-#else
-      p->_currentCIE = p->_currentLevel;
-#endif
+      if (p->_currentLevel == p->_targetLevel && p->_waitTime == 0 &&
+          p->_queueHead != p->_queueTail && p->_effect.type == EFFECT_NONE &&
+          !(scene && p->_inScene)) {
+        turnFadeOff        = false;  // switch flag off
+        setStructure &slot = p->_queue[p->_queueHead & (SET_QUEUE_SIZE - 1)];
+        p->startFade(slot.targetLevel, slot.changeDelays, slot.delayMS);  // rate is precomputed
+        traceEvent(TRACE_DEQUEUE, led, slot.targetLevel);
+        ++p->_queueHead;  // remove it from the ring
+      }                   // if-then we have another set command
       /*********************************************************************************************
-       ** If the pin is set to "ON" or "OFF", then turn off PWM and explicitly set the pin to the **
-       ** state requested                                                                         **
-       ********************************************************************************************/
-      if (p->_currentLevel == 0 || p->_currentLevel == 255) {  // if PWM on and value is ON or OFF
-        p->_flags &= ~PWM_ACTIVE;                              // turn off PWM flag
-        p->switchHardwarePWM(false);                           // turn off PWM mode if using HW PWM
-        if (p->_currentLevel == 0) {
-          p->pinOff();
-        } else {
-          p->pinOn();
-        }  // if-then turn "OFF" or "ON"
-      } else {
-        p->_flags |= PWM_ACTIVE;  // turn on PWM flag
-        /*******************************************************************************************
-        ** If we have a PWM value and we are in hardware mode, then actually set the register to  **
-        ** the PWM value. If we are in software mode, then do nothing, the toggling is handled by **
-        ** the interrupt handler "pwmISR()".                                                      **
-        *******************************************************************************************/
-        if (!(p->_flags & SOFTWARE_MODE)) {  // If we are in hardware PWM mode
-          p->switchHardwarePWM(true);        // turn on PWM mode if using HW pin
-          if (p->_flags & INVERT_LED) {      // Set depending upon inverted flag state
-            if (p->_flags & TIMER1_PIN) {    // TIMER1 pins are 10 bit and re-casting and shifting
-              *(volatile uint16_t *)p->_PWMRegister = ((uint16_t)(255) - p->_currentCIE) << 2;
-            } else {
-              *p->_PWMRegister = 255 - p->_currentCIE;
-            }  // if-then TIMER1 pin
-          } else {
-            if (p->_flags & TIMER1_PIN) {  // TIMER1 pins are 10 bit and re-casting and shifting
-              *(volatile uint16_t *)p->_PWMRegister = (uint16_t)p->_currentCIE << 2;
-            } else {
-              *p->_PWMRegister = p->_currentCIE;
-            }  // if-then TIMER1 pin
-          }    // if-then inverted
-        }      // if-then hardware PWM
-      }        // if-then-else "ON" or "OFF"
-
-      if ((p->_flags & PWM_ACTIVE) &&     // and PWM is on,
-          (p->_flags & SOFTWARE_MODE)) {  // and not using hardware mode
-        turnPWMoff = false;               // set flag
-      }                                   // if-then software PWM
+      ** Only set the CIE value and the pin or PWM register when the level has changed in this    **
+      ** tick, or when the pin was initialized or a brightness scale was changed                  **
+      *********************************************************************************************/
+      if (refresh || p->_currentLevel != previous) {  // If the output has to be recomputed
+        if (p->_flags & TEMPLATE_LED) {               // then for a "smoothLEDT" instance
+          p->_flags |= OUTPUT_DUE;                    // leave it to its type,
+          outputDue = true;
+        } else {                                      // otherwise
+          p->updateOutput();                          // set the CIE value and the pin
+        }                                             // if-then-else "smoothLEDT" instance
+      }                                               // if-then output changed
+      if ((p->_flags & (PWM_ACTIVE | SOFTWARE_MODE | OUTPUT_DUE)) ==  // and PWM is on, not using
+          (PWM_ACTIVE | SOFTWARE_MODE)) {  // hardware mode and not left to a "smoothLEDT" type
+        turnPWMoff = false;                // set flag
+      }                                    // if-then software PWM
+      /*********************************************************************************************
+      ** Compute the number of ticks that can be skipped before this LED has something to do. A   **
+      ** fade step is due in the tick in which the ticker has reached 128 or less, and the next   **
+      ** stacked command is started in the tick in which the wait time reaches 0                  **
+      *********************************************************************************************/
+      uint16_t idle{UINT8_MAX};                          // ticks until this LED has something to do
+      if (scene && p->_inScene) {                        // A crossfade changes levels every tick
+        turnFadeOff = false;
+        idle        = 0;
+      } else if (p->_effect.type != EFFECT_NONE) {       // When running an effect, the next update
+        turnFadeOff = false;
+        idle        = p->_effect.ticker - 1;
+      } else if (p->_currentLevel != p->_targetLevel) {  // When fading, the ticks to the next step
+        idle = p->_changeTicker > 128 ? (p->_changeTicker - 1) >> 7 : 0;
+      } else if (p->_waitTime) {                         // when waiting, the ticks until it ends
+        idle = p->_waitTime - 1;
+      } else if (p->_queueHead != p->_queueTail) {       // and the next stacked command is due now
+        idle = 0;
+      }                                                  // if-then-else fading, waiting or stacked
+      if (idle < sleep) sleep = idle;                    // keep the lowest value of all LEDs
     }                                     // if pin defined
+#ifdef SMOOTHLED_TRACE
+    ++led;
+#endif
     p = p->_nextLink;                     // go to next class instance
   }                                       // of while loop to traverse list
   /*************************************************************************************************
   ** If no pins in our class instances are actively fading, the we can turn off this interrupt    **
-  ** and save a bit of CPU cycles. Interrupts are re-enabled in the "set()" function              **
+  ** and save a bit of CPU cycles, unless tick callbacks are attached. Interrupts are re-enabled  **
+  ** in the "set()" function                                                                      **
   *************************************************************************************************/
-  if (turnFadeOff) {  // Disable interrupts when not needed
+  if (outputDue) {                                                // Set the "smoothLEDT"
+    for (ledGroup *g = _firstGroup; g != nullptr; g = g->next) {  // outputs of each type
+      if (g->output()) turnPWMoff = false;                        // which might need PWM
+    }                                                             // for-next each type
+  }                                                               // if-then outputs due
+  _sleepTicks = sleep;                    // Skip the ticks in which nothing is due
+  if (turnFadeOff) {                      // Disable interrupts when not needed
     fadeTimerOff;
     /***********************************************************************************************
     ** And perform a check to see if we can turn off TIMER1 if no pins in our class instances are **
@@ -846,4 +1562,412 @@ void smoothLED::faderISR() {
       pwmTimerOff;
     }  // if-then turn PWM off
   }    // if-then turn off fading
+#ifdef SMOOTHLED_TRACE
+  if (fadePending) traceEvent(TRACE_OVERRUN, 0, 1);  // Next interrupt is already due
+#endif
 }  // of function "faderISR()"
+#ifdef FRAME_SYNC_ACTIVE
+bool smoothLED::setSync(const uint8_t mode, const uint8_t pin) {
+  /*!
+    @brief     Synchronizes the PWM frames and fader ticks of several boards
+    @details   With SYNC_MASTER a pulse of SYNC_PULSE PWM steps is output on "pin" at the start of
+               every PWM frame, so the PWM interrupt stays enabled. With SYNC_SLAVE each rising edge
+               on "pin" calls "syncISR()" and the fader interrupt stays enabled so that every tick
+               is counted. SYNC_OFF stops either of them. This has to be called after the first
+               "begin()", which sets up the timers
+    @param[in] mode SYNC_OFF, SYNC_MASTER or SYNC_SLAVE
+    @param[in] pin  Arduino pin of the sync wire, not used with SYNC_OFF
+    @return    bool FALSE when the pin of a slave can't be used with "attachInterrupt()"
+  */
+  if (mode == SYNC_SLAVE && digitalPinToInterrupt(pin) == NOT_AN_INTERRUPT) return false;
+  if (_syncMode == SYNC_SLAVE) detachInterrupt(digitalPinToInterrupt(_syncPin));
+  uint8_t originalSREG = SREG;  // Save original SREG value
+  cli();                        // disable interrupts while changing
+  _syncPort = nullptr;          // stop the master pulses
+  _syncMode = SYNC_OFF;         // and the slave corrections
+  SREG      = originalSREG;     // Restore interrupt state to original
+  if (mode == SYNC_MASTER) {    // The master drives the wire
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, LOW);
+  } else if (mode == SYNC_SLAVE) {  // and the slaves listen
+    pinMode(pin, INPUT);
+  }  // if-then-else master or slave
+  cli();  // disable interrupts while changing
+  _syncPin   = pin;
+  _syncTicks = UINT8_MAX;  // the first pulse only starts the count
+  _syncPhase = 0;
+  _syncError = 0;
+  if (mode == SYNC_MASTER) {  // The master's pwmISR() drives the pin
+    _syncPort = portOutputRegister(digitalPinToPort(pin));
+    _syncMask = digitalPinToBitMask(pin);
+  }  // if-then master
+  _syncMode = mode;
+  SREG      = originalSREG;  // Restore interrupt state to original
+  if (mode == SYNC_SLAVE) attachInterrupt(digitalPinToInterrupt(pin), syncISR, RISING);
+  fadeTimerOn;  // turn on fade interrupt
+  pwmTimerOn;   // turn on PWM interrupt, turned off again when idle
+  return true;
+}  // of function "setSync()"
+int8_t smoothLED::syncError() {
+  /*!
+    @brief   Returns the PWM frame phase error measured at the last sync pulse
+    @return  int8_t error in PWM steps of 1024 CPU cycles, positive when the own frame started
+             before the pulse
+  */
+  return _syncError;
+}  // of function "syncError()"
+void smoothLED::syncISR() {
+  /*!
+    @brief   Locks the PWM frame and the fader ticks to a sync pulse
+    @details Called by the external interrupt on each rising edge of the sync wire. "_counterPWM" is
+             the next step of the own PWM frame, so as a signed value it is the phase error: above
+             0 when the own frame started before the pulse and below 0 when it is about to start.
+             Within SYNC_MAX_STEP steps the frame is restarted with the next step, otherwise it is
+             moved back by SYNC_MAX_STEP steps, which only makes the LEDs that are still on stay on
+             a little longer in this frame. The difference between the expected and the counted
+             fader ticks is added to "_syncPhase" for "syncTicks()". It is limited to less than two
+             ticks, so at most one tick per frame is corrected. The count is ignored for the first
+             pulse and when pulses were missed. Without SYNC_SLAVE only the error is measured
+  */
+  const int16_t LIMIT{2 * 256 - 1};           // largest tick phase, in 1/256 ticks
+  int8_t        error = (int8_t)_counterPWM;  // steps since the start of the own frame
+  _syncError          = error;                // store for "syncError()"
+  if (_syncMode != SYNC_SLAVE) return;        // only measure when not a slave
+  if (error >= -(int8_t)SYNC_MAX_STEP && error <= (int8_t)SYNC_MAX_STEP) {
+    _counterPWM = 0;               // restart the frame with the next step
+  } else {                         // otherwise
+    _counterPWM -= SYNC_MAX_STEP;  // move it back by the largest correction
+  }                                // if-then-else small error
+  uint8_t nominal = SYNC_NOMINAL >> 8;  // whole ticks per frame
+  if (_syncTicks >= nominal / 2 && (uint16_t)_syncTicks <= nominal * 2) {  // count is plausible
+    _syncPhase += (int16_t)(SYNC_NOMINAL - ((uint16_t)_syncTicks << 8));
+    if (_syncPhase > LIMIT) _syncPhase = LIMIT;
+    if (_syncPhase < -LIMIT) _syncPhase = -LIMIT;
+  }                // if-then count plausible
+  _syncTicks = 0;  // start counting for the next pulse
+}  // of function "syncISR()"
+uint8_t smoothLED::syncTicks(const uint8_t ticks) {
+  /*!
+    @brief     Returns the number of fader ticks to run in this fader interrupt
+    @details   Called from the fader interrupt before "faderISR()". This is "ticks" unless in
+               SYNC_SLAVE mode, where the ticks are counted for "syncISR()" and an extra tick is
+               run when the board has fallen a whole tick behind the master, or a tick is skipped
+               when it is a whole tick ahead. When no tick is due the skip waits for the next one
+    @param[in] ticks Fader ticks due in this interrupt, 1 on the ATMega processors
+    @return    uint8_t corrected number of ticks
+  */
+  if (_syncMode != SYNC_SLAVE) return ticks;  // Return immediately when not a slave
+  if (_syncTicks < UINT8_MAX - ticks) {       // count the ticks between pulses, the
+    _syncTicks += ticks;                      // count stays at UINT8_MAX once it is
+  } else {                                    // too large to be plausible
+    _syncTicks = UINT8_MAX;
+  }                          // if-then-else count ticks
+  if (_syncPhase >= 256) {   // If a whole tick behind the master
+    _syncPhase -= 256;       // then catch up
+    return ticks + 1;        // with an extra tick
+  }                          // if-then behind
+  if (_syncPhase <= -256 &&  // If a whole tick ahead of the master
+      ticks != 0) {          // and a tick is due
+    _syncPhase += 256;       // then wait
+    return ticks - 1;        // by skipping it
+  }                          // if-then ahead
+  return ticks;
+}  // of function "syncTicks()"
+#endif
+#ifdef SMOOTHLED_TRACE
+void smoothLED::trace(const uint8_t event, const uint8_t value) {
+  /*!
+    @brief     Writes an event with a timestamp to the trace ring buffer
+    @details   Called from the interrupt handlers and from the functions that switch the interrupts
+               on or off, so interrupts are disabled for the few instructions needed to write the
+               entry. When the ring is full the oldest entry is overwritten
+    @param[in] event Event type in bits 5-7 and LED number in bits 0-4
+    @param[in] value Event specific value
+  */
+  uint8_t originalSREG = SREG;                // Save original SREG value
+  cli();                                      // disable interrupts while writing the entry
+  traceEntry &entry = _trace[_traceHead];     // next entry to write
+  entry.event       = event;
+  entry.value       = value;
+#ifdef SMOOTHLED_MODERN_AVR
+  uint8_t  count     = TCA0.SPLIT.LCNT;                  // counts down from LPER to 0
+  uint16_t overflows = _traceOverflows;                  // TCA0 periods counted by the fader
+  if (TCA0.SPLIT.INTFLAGS & TCA_SPLIT_LUNF_bm) {         // If an underflow isn't counted yet
+    count = TCA0.SPLIT.LCNT;                             // then the count is after it, so
+    ++overflows;                                         // count it here
+  }                                                      // if-then underflow pending
+  entry.time = overflows * (TCA0.SPLIT.LPER + 1) + (TCA0.SPLIT.LPER - count);
+#else
+  uint8_t count     = TCNT0;                                   // counts up from 0 to 255
+  uint8_t overflows = *(volatile uint8_t *)&timer0_overflow_count;  // periods counted by millis()
+  if (TIFR0 & _BV(TOV0)) {                                     // If an overflow isn't counted yet
+    count = TCNT0;                                             // then the count is after it, so
+    ++overflows;                                               // count it here
+  }                                                            // if-then overflow pending
+  entry.time = (uint16_t)overflows << 8 | count;
+#endif
+  _traceHead        = (_traceHead + 1) & (TRACE_SIZE - 1);
+  if (_traceHead == 0) _traceWrapped = true;  // oldest entries are now overwritten
+  SREG = originalSREG;                        // Restore interrupt state to original
+}  // of function "trace()"
+uint8_t smoothLED::ledNumber() const {
+  /*!
+    @brief   Returns the position of the LED in the linked list, which is used in the trace events
+    @return  uint8_t 0 for the first LED declared
+  */
+  uint8_t    number{0};
+  smoothLED *p = _firstLink;  // Start pointer at top of list
+  while (p != this) {         // loop until this instance
+    p = p->_nextLink;         // increment to next element
+    ++number;
+  }                           // of while loop
+  return number;
+}  // of function "ledNumber()"
+void smoothLED::dumpTrace(Stream &port) {
+  /*!
+    @brief     Writes the trace events to a Stream and clears the trace
+    @details   The ring is copied and cleared with interrupts disabled and then written as CSV lines
+               "time,type,led,value", oldest first, after a header line with the CPU frequency, the
+               number of CPU cycles per timestamp unit and per fader tick. The
+               "extras/trace_decode.py" program converts the output into a timeline. The copy is
+               made on the stack, so this needs another TRACE_SIZE * 4 Bytes of RAM while it runs
+    @param[in] port Stream to write to, usually "Serial"
+  */
+  traceEntry copy[TRACE_SIZE];                     // events are written from the copy
+  uint8_t    originalSREG = SREG;                  // Save original SREG value
+  cli();                                           // disable interrupts while copying
+  uint8_t first = _traceWrapped ? _traceHead : 0;  // oldest entry
+  uint8_t count = _traceWrapped ? TRACE_SIZE : _traceHead;
+  memcpy(copy, _trace, sizeof(copy));
+  _traceHead    = 0;                               // clear the trace
+  _traceWrapped = false;
+  SREG          = originalSREG;                    // Restore interrupt state to original
+  port.print(F("# smoothLED trace F_CPU="));
+  port.print(F_CPU);
+#ifdef SMOOTHLED_MODERN_AVR
+  port.print(F(" unit="));
+  port.print(tcaPrescaler());  // CPU cycles per TCA0 count
+  port.print(F(" fader="));
+  port.print(F_CPU / 1000);  // fader ticks are 1ms
+#else
+  port.print(F(" unit=64 fader=16384"));  // TCNT0 counts and TIMER0 periods
+#endif
+  port.print(F(" events="));
+  port.println(count);
+  port.println(F("time,type,led,value"));
+  for (uint8_t i = 0; i < count; ++i) {
+    const traceEntry &entry = copy[(first + i) & (TRACE_SIZE - 1)];
+    port.print(entry.time);
+    port.print(',');
+    port.print(entry.event >> 5);
+    port.print(',');
+    port.print(entry.event & 0x1F);
+    port.print(',');
+    port.println(entry.value);
+  }  // for-next each event
+}  // of function "dumpTrace()"
+#endif
+smoothLEDStream::smoothLEDStream(Stream &port) : _port(port) {
+  /*!
+  @brief     Class constructor
+  @details   The Stream (usually "Serial") needs to have been started by the sketch, this class only
+             reads frames from it and writes the single-byte XON/XOFF flow control characters
+  @param[in] port Stream from which the binary frames are read
+  */
+}  // of smoothLEDStream class constructor
+uint8_t smoothLEDStream::pending() const {
+  /*!
+  @brief   Returns the number of decoded frames that are waiting to be dispatched
+  @return  uint8_t number of frames in the receive ring
+  */
+  return _ringTail - _ringHead;  // indices wrap at 256, so difference is always correct
+}  // of function "pending()"
+uint16_t smoothLEDStream::errors() const {
+  /*!
+  @brief   Returns the number of frames discarded due to a bad checksum
+  @return  uint16_t count of discarded frames
+  */
+  return _errors;
+}  // of function "errors()"
+bool smoothLEDStream::dispatch(const streamCommand &cmd) const {
+  /*!
+  @brief     Applies one decoded frame to the addressed LEDs
+  @details   A STREAM_SET frame is held back if any of the addressed LEDs has no room left in its
+             command ring, this is what eventually fills the receive ring and causes an XOFF to be
+             sent. A STREAM_SET_NOW frame discards the stacked commands and is always applied.
+  @param[in] cmd Decoded frame
+  @return    bool TRUE when the frame was applied, FALSE when it has to be retried later
+  */
+  smoothLED *first = smoothLED::_firstLink;  // find the first addressed LED
+  for (uint8_t i = 0; i < cmd.index && first != nullptr; ++i) {
+    first = first->_nextLink;
+  }                              // for-next skip to first LED
+  smoothLED *p     = first;      // check that all addressed LEDs have room
+  uint8_t    count = cmd.count;  // 0 means all LEDs, and decrementing 0 never reaches 0 again
+  if (cmd.command == STREAM_SET) {
+    while (p != nullptr) {
+      if ((uint8_t)(p->_queueTail - p->_queueHead) >= SET_QUEUE_SIZE) return false;  // retry later
+      if (--count == 0) break;                                // stop after last addressed LED
+      p = p->_nextLink;
+    }  // while loop through addressed LEDs
+  }    // if-then "set()" command
+  p     = first;
+  count = cmd.count;
+  while (p != nullptr) {
+    if (cmd.command == STREAM_SET_NOW) {
+      p->setNow(cmd.level, cmd.speed, cmd.delay);
+    } else {
+      p->set(cmd.level, cmd.speed, cmd.delay);
+    }  // if-then-else "setNow()" or "set()"
+    if (--count == 0) break;  // stop after last addressed LED
+    p = p->_nextLink;
+  }              // while loop through addressed LEDs
+  return true;  // frame was applied
+}  // of function "dispatch()"
+void smoothLEDStream::poll() {
+  /*!
+  @brief     Reads and decodes frames from the stream and applies them to the LEDs
+  @details   This function is called from "loop()" as often as possible. It never blocks, it only
+             consumes bytes already in the UART receive buffer. Bytes are only read while there is
+             room in the ring for another frame, so when the ring is full the remaining bytes stay
+             in the UART buffer and an XOFF is sent to the host. An XON is sent once the ring has
+             drained to half full. Frames with a bad checksum are counted and discarded, and the
+             decoder resynchronizes on the next SYNC byte.
+  */
+  while (pending() < STREAM_RING_SIZE && _port.available() > 0) {
+    uint8_t c = _port.read();                            // get next byte from receive buffer
+    if (_framePos == 0 && c != STREAM_SYNC) continue;    // skip until start of a frame
+    _frame[_framePos++] = c;                             // store byte
+    if (_framePos < STREAM_FRAME_SIZE) continue;         // wait for the rest of the frame
+    _framePos = 0;                                       // next byte starts a new frame
+    uint8_t check{0};                                    // XOR checksum of the payload
+    for (uint8_t i = 1; i < STREAM_FRAME_SIZE - 1; ++i) check ^= _frame[i];
+    if (check != _frame[STREAM_FRAME_SIZE - 1] || _frame[1] > STREAM_SET_NOW) {
+      ++_errors;  // discard frame
+      continue;
+    }  // if-then bad frame
+    streamCommand &cmd = _ring[_ringTail & (STREAM_RING_SIZE - 1)];
+    cmd.command        = _frame[1];
+    cmd.index          = _frame[2];
+    cmd.count          = _frame[3];
+    cmd.level          = _frame[4];
+    cmd.speed          = _frame[5] | (uint16_t)_frame[6] << 8;
+    cmd.delay          = _frame[7] | (uint16_t)_frame[8] << 8;
+    ++_ringTail;  // publish the frame
+  }               // while there is room and data
+  while (pending() != 0 && dispatch(_ring[_ringHead & (STREAM_RING_SIZE - 1)])) {
+    ++_ringHead;  // frame applied, remove from ring
+  }               // while frames can be applied
+  if (!_paused && pending() == STREAM_RING_SIZE) {
+    _port.write(STREAM_XOFF);  // ring is full, ask the sender to pause
+    _paused = true;
+  } else if (_paused && pending() <= STREAM_RING_SIZE / 2) {
+    _port.write(STREAM_XON);  // ring has room again, let the sender resume
+    _paused = false;
+  }  // if-then-else flow control
+}  // of function "poll()"
+bool smoothLEDTick::attach(void (*callback)(), const uint8_t divisor, const uint8_t budget) {
+  /*!
+    @brief     Attaches a function that is called from the fader interrupt
+    @details   The function is called in every "divisor" ticks of about 1ms with interrupts
+               disabled. If a single call takes longer than "budget" units of 64 CPU cycles it is
+               detached and "overruns()" is incremented. The cost is measured to +/-1 unit, and
+               a call of 255 units or more can't be told apart from a short one in the 8-bit
+               counter difference, so the budget is limited to 254. Attaching a function that is
+               already attached only changes its divisor and budget. The fader interrupt is
+               enabled and stays enabled while any function is attached
+    @param[in] callback Function without parameters or return value
+    @param[in] divisor  Call the function in every "divisor" ticks, 1-255
+    @param[in] budget   Largest allowed cost of a call in units of 64 CPU cycles, 1-254. 0 and
+                        larger values are treated as 254
+    @return    bool     FALSE when all TICK_CALLBACKS entries are in use
+  */
+  if (callback == nullptr) return false;                   // nothing to call
+  tickEntry *entry{nullptr};                               // entry to use
+  uint8_t    originalSREG = SREG;                          // Save original SREG value
+  cli();                                                   // disable interrupts while changing
+  for (uint8_t i = 0; i < TICK_CALLBACKS; ++i) {           // loop through the table
+    if (_table[i].callback == callback) {                  // if it is already attached
+      entry = &_table[i];                                  // then change that entry
+      break;                                               // and stop looking
+    }                                                      // if-then already attached
+    if (entry == nullptr && _table[i].callback == nullptr) entry = &_table[i];  // first free
+  }                                                        // for-next each entry
+  if (entry != nullptr) {                                  // if there is an entry to use
+    if (entry->callback == nullptr) ++_clients;            // count a new callback
+    entry->callback = callback;
+    entry->divisor  = divisor ? divisor : 1;
+    entry->counter  = entry->divisor;
+    entry->budget   = (budget == 0 || budget > TICK_BUDGET_MAX) ? TICK_BUDGET_MAX : budget;
+    entry->worst    = 0;
+  }                                                        // if-then entry found
+  SREG = originalSREG;                                     // Restore interrupt state to original
+  if (entry == nullptr) return false;                      // table is full
+  fadeTimerOn;                                             // turn on fade interrupt
+  return true;
+}  // of function "attach()"
+void smoothLEDTick::detach(void (*callback)()) {
+  /*!
+    @brief     Detaches a function attached with "attach()"
+    @details   The fader interrupt is turned off in its next tick if no LED needs it either
+    @param[in] callback Function to detach, nothing is done if it isn't attached
+  */
+  uint8_t originalSREG = SREG;                       // Save original SREG value
+  cli();                                             // disable interrupts while changing
+  for (uint8_t i = 0; i < TICK_CALLBACKS; ++i) {     // loop through the table
+    if (callback != nullptr && _table[i].callback == callback) {
+      _table[i].callback = nullptr;                  // free the entry
+      --_clients;
+    }                                                // if-then found
+  }                                                  // for-next each entry
+  SREG = originalSREG;                               // Restore interrupt state to original
+  fadeTimerOn;                                       // next tick checks if it is still needed
+}  // of function "detach()"
+uint8_t smoothLEDTick::cost(void (*callback)()) {
+  /*!
+    @brief     Returns the largest measured cost of an attached function
+    @details   The cost is measured with the timer counter and includes the call itself, so the
+               resolution is 1 unit of 64 CPU cycles
+    @param[in] callback Attached function
+    @return    uint8_t cost in units of 64 CPU cycles, 0 if the function isn't attached
+  */
+  for (uint8_t i = 0; i < TICK_CALLBACKS; ++i) {
+    if (callback != nullptr && _table[i].callback == callback) return _table[i].worst;
+  }  // for-next each entry
+  return 0;
+}  // of function "cost()"
+uint8_t smoothLEDTick::overruns() {
+  /*!
+    @brief   Returns the number of functions that were detached because they were over budget
+    @return  uint8_t number of detached functions since startup
+  */
+  return _overruns;
+}  // of function "overruns()"
+void smoothLEDTick::tickISR() {
+  /*!
+    @brief   Calls the attached functions that are due in this tick
+    @details Called from the fader interrupt before "faderISR()". The timer counter is read before
+             and after each call and "tickCost()" converts the difference to units of 64 CPU cycles,
+             which is correct across an overflow, as long as a call takes less than one timer
+             period of about 255 units. Since the counter can advance just before or just after a
+             call starts, the measured cost is within one count of the real one, which is 1 unit
+             unless the TCA0 divider of a megaAVR or AVR-Dx core is larger than 64
+  */
+  if (_clients == 0) return;                                  // Return immediately when none
+  for (uint8_t i = 0; i < TICK_CALLBACKS; ++i) {              // loop through the table
+    tickEntry &entry = _table[i];
+    if (entry.callback != nullptr && --entry.counter == 0) {  // If attached and due
+      entry.counter = entry.divisor;                          // then restart the counter,
+      uint8_t start = tickCount;                              // measure
+      entry.callback();                                       // the call
+      uint8_t cost = tickCost(start, tickCount);
+      if (cost > entry.worst) entry.worst = cost;             // remember the worst case
+      if (cost > entry.budget) {                              // If over budget
+        entry.callback = nullptr;                             // then detach it
+        --_clients;
+        ++_overruns;
+        traceEvent(TRACE_OVERRUN, i, 2);
+      }                                                       // if-then over budget
+    }                                                         // if-then due
+  }                                                           // for-next each entry
+}  // of function "tickISR()"
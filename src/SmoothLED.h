@@ -49,6 +49,21 @@ Written by Arnd <Arnd@Zanduino.Com> at https://www.github.com/SV-Zanshin
 
 | Version| Date       | Developer  | Comments                                                      |
 | ------ | ---------- | ---------- | ------------------------------------------------------------- |
+| 1.1.0  | 2026-10-18 | SV-Zanshin | Added "smoothLEDStream" binary serial command protocol        |
+|        |            |            | Added "getLevel()" and "isBusy()" for timing verification     |
+|        |            |            | faderISR() no longer skips LEDs when a stacked set() starts   |
+|        |            |            | Fade rates of stacked set() commands computed when stacked    |
+|        |            |            | set() and setNow() use a lock-free ring, no interrupt disable |
+|        |            |            | set() returns false when the ring of SET_QUEUE_SIZE is full   |
+|        |            |            | Added "smoothLEDT" template with compile-time pin behaviour   |
+|        |            |            | faderISR() sleeps until the next level change or end of wait  |
+|        |            |            | Added master brightness and per-LED maximum level scaling     |
+|        |            |            | Added megaAVR 0-series and AVR-Dx support using TCA0 and TCB  |
+|        |            |            | Added optional event trace buffer and "dumpTrace()"           |
+|        |            |            | Added candle, strobe, noise and heartbeat effects             |
+|        |            |            | Added 1kHz tick callbacks sharing the fader interrupt         |
+|        |            |            | Added multi-board PWM frame and fader tick synchronization    |
+|        |            |            | Added PROGMEM scenes and "crossfadeTo()" for all LEDs at once |
 | 1.0.0  | 2021-01-21 | SV-Zanshin | Created new library for the class                             |
 */
 
@@ -90,6 +105,103 @@ const PROGMEM uint8_t kcie[] = {
     177, 179, 181, 183, 185, 187, 189, 191, 194, 196, 198, 200, 202, 204, 206, 209, 211, 213, 215,
     218, 220, 222, 224, 227, 229, 231, 234, 236};
 #endif
+#define MASTER_BRIGHTNESS_ACTIVE  //!< Set the master brightness function to be active
+/***************************************************************************************************
+** The master brightness scales the level of all LEDs before the CIE table lookup. The scaled     **
+** level is computed with an 8x8 bit multiplication only when the level of an LED or one of the   **
+** scales has changed, so it costs a single Byte of RAM. If the following "#define                **
+** MASTER_BRIGHTNESS_ACTIVE" is commented out the multiplication and the "setMasterBrightness()"  **
+** function are removed. The per-LED "setMaxLevel()" is unaffected.                               **
+***************************************************************************************************/
+// #define FRAME_SYNC_ACTIVE  //!< Uncomment to activate the multi-board frame synchronization
+/***************************************************************************************************
+** Several boards can be synchronized with a wire between them (and a common ground). The board   **
+** set to SYNC_MASTER outputs a pulse at the start of every software PWM frame, the boards set to **
+** SYNC_SLAVE get an external interrupt on each rising edge. There the position in the own PWM    **
+** frame is the phase error: when it is within SYNC_MAX_STEP steps the frame is restarted, else   **
+** it is moved back by SYNC_MAX_STEP steps, so a frame is never shortened by more than that and   **
+** at most nearly full LEDs miss their switch-off point once. The fader ticks counted between two **
+** pulses are compared to the number expected from the timer settings and the difference is       **
+** summed up; once it reaches a whole tick one fader tick is run twice or skipped, at most one    **
+** per frame. This keeps fades on all boards ending in the same tick even with clock differences  **
+** of several percent. Only if the "#define FRAME_SYNC_ACTIVE" above is uncommented are           **
+** "setSync()" and the checks in the interrupts compiled in, the tick callbacks are always called **
+** once per fader interrupt.                                                                      **
+***************************************************************************************************/
+/***************************************************************************************************
+** The megaAVR 0-series (e.g. ATmega4809) and AVR-Dx (e.g. AVR128DA) processors have different    **
+** timers. There the library piggybacks off the low byte underflow interrupt of TCA0, which the   **
+** Arduino cores run in split mode for two sets of three 8-bit PWM channels, for fading. The      **
+** underflow rate depends on the core and the clock, e.g. 980Hz on a 16MHz ATmega4809 and 1470Hz  **
+** on a 24MHz AVR128DA, so the period is read from TCA0 in "begin()" and added up in units of 16  **
+** CPU cycles; a fader tick is run whenever a whole millisecond has been collected. The ticks     **
+** average exactly 1ms with a jitter of one underflow period for any F_CPU up to 48MHz and any    **
+** TCA0 setup of the core. The software PWM uses TCB number SMOOTHLED_TCB_NUMBER in periodic      **
+** interrupt mode at F_CPU/1024, the same rate as on the ATMega processors. It must not be a TCB  **
+** used by the Arduino core for millis(), tone(), Servo or analogWrite(). TCB2 is used by         **
+** default, or TCB3 when the core reports that millis() uses TCB2 (MILLIS_USE_TIMERB2, the DxCore **
+** default); a different TCB can be set with a compiler option such as                            **
+** "-DSMOOTHLED_TCB_NUMBER=1". Hardware PWM is used on the pins of the six TCA0 channels and pins **
+** are switched with single writes to the PORT OUTSET and OUTCLR registers.                       **
+***************************************************************************************************/
+#if defined(__AVR_XMEGA__) && defined(TCA0)
+#define SMOOTHLED_MODERN_AVR  //!< Processor with TCA/TCB timers
+#ifndef SMOOTHLED_TCB_NUMBER
+#if !defined(MILLIS_USE_TIMERB2)
+#define SMOOTHLED_TCB_NUMBER 2  //!< TCB used for the software PWM interrupt
+#elif defined(TCB3)
+#define SMOOTHLED_TCB_NUMBER 3  //!< TCB used for the software PWM interrupt, TCB2 runs millis()
+#else
+#error millis() uses TCB2 and there is no TCB3, set SMOOTHLED_TCB_NUMBER to an unused TCB
+#endif
+#endif
+#if (SMOOTHLED_TCB_NUMBER == 0 && defined(MILLIS_USE_TIMERB0)) ||   \
+    (SMOOTHLED_TCB_NUMBER == 1 && defined(MILLIS_USE_TIMERB1)) ||   \
+    (SMOOTHLED_TCB_NUMBER == 2 && defined(MILLIS_USE_TIMERB2)) ||   \
+    (SMOOTHLED_TCB_NUMBER == 3 && defined(MILLIS_USE_TIMERB3)) ||   \
+    (SMOOTHLED_TCB_NUMBER == 4 && defined(MILLIS_USE_TIMERB4))
+#error SMOOTHLED_TCB_NUMBER is the TCB that millis() uses, set it to an unused TCB
+#endif
+#define SMOOTHLED_PASTE(a, b, c) a##b##c                                  //!< Paste 3 tokens
+#define SMOOTHLED_NAME(a, b, c) SMOOTHLED_PASTE(a, b, c)                   //!< Expand and paste
+#define SMOOTHLED_TCB SMOOTHLED_NAME(TCB, SMOOTHLED_TCB_NUMBER, )          //!< TCB peripheral
+#define SMOOTHLED_TCB_vect SMOOTHLED_NAME(TCB, SMOOTHLED_TCB_NUMBER, _INT_vect)  //!< TCB vector
+#endif
+// #define SMOOTHLED_TRACE  //!< Uncomment to record interrupt events for "dumpTrace()"
+/***************************************************************************************************
+** When SMOOTHLED_TRACE is defined the interrupt handlers write compact, timestamped events into  **
+** a ring buffer of TRACE_SIZE entries in RAM, which "smoothLED::dumpTrace()" writes to a Stream  **
+** for the "extras/trace_decode.py" program to render as a timeline. Each event is 4 Bytes: the   **
+** event type in the top 3 bits and the LED number (in order of declaration) in the low 5 bits of **
+** the first Byte, a value Byte and a 16-bit timestamp. On the ATMega processors the timestamp is **
+** the low Byte of the millis() overflow counter and TCNT0, in units of 64 CPU cycles, so writing **
+** an event only takes a few loads and stores. On the megaAVR and AVR-Dx processors the TCA0      **
+** underflows are counted in the fader interrupt, which then stays enabled, and the timestamp is  **
+** that count times the TCA0 period plus the TCA0 count, in units of the TCA0 clock divider. The  **
+** trace uses 258 Bytes of RAM (260 on the megaAVR and AVR-Dx) and slows down the interrupts, so  **
+** it is disabled by default.                                                                     **
+***************************************************************************************************/
+#ifdef SMOOTHLED_TRACE
+const uint8_t TRACE_SIZE{64};     //!< Number of events in the ring buffer, must be a power of 2
+const uint8_t TRACE_FRAME{0};     //!< pwmISR() started a new PWM frame
+const uint8_t TRACE_FADER{1};     //!< faderISR() full pass, value is the number of skipped ticks
+const uint8_t TRACE_STEP{2};      //!< Fade step, value is the new level
+const uint8_t TRACE_DEQUEUE{3};   //!< Stacked command started, value is the target level
+const uint8_t TRACE_CANCEL{4};    //!< "setNow()" cancellation handled by faderISR()
+const uint8_t TRACE_TIMER{5};     //!< Interrupt switched, value is one of the TRACE_xxx_ON/OFF
+const uint8_t TRACE_OVERRUN{6};   //!< Next interrupt due at end of handler, or callback too slow
+const uint8_t TRACE_FULL{7};      //!< "set()" ignored because the ring of the LED was full
+const uint8_t TRACE_FADE_OFF{0};  //!< TRACE_TIMER value, fader interrupt disabled
+const uint8_t TRACE_FADE_ON{1};   //!< TRACE_TIMER value, fader interrupt enabled
+const uint8_t TRACE_PWM_OFF{2};   //!< TRACE_TIMER value, PWM interrupt disabled
+const uint8_t TRACE_PWM_ON{3};    //!< TRACE_TIMER value, PWM interrupt enabled
+/*! @brief One event in the trace ring buffer */
+struct traceEntry {
+  uint8_t  event;  //!< Event type in bits 5-7, LED number in bits 0-4
+  uint8_t  value;  //!< Event specific value
+  uint16_t time;   //!< Timestamp, see above
+};  // of struct "traceEntry"
+#endif
 
 /***************************************************************************************************
 ** Not all of these macros are defined on all platforms, so redefine them here just in case       **
@@ -112,13 +224,118 @@ const uint8_t CIE_MODE{0};       //!< Default. Interpolate brightness using CIE
 const uint8_t NO_CIE_MODE{2};    //!< Use the PWM value directly, do not interpolate values
 const uint8_t HARDWARE_MODE{0};  //!< Default. Use hardware PWM where possible
 const uint8_t SOFTWARE_MODE{4};  //!< Use software PWM even on Hardware PWM pins
-/*! Define the linked list structure for stacking set() commands */
+const uint8_t PWM_ACTIVE{8};     //!< Internal. Set when PWM is active on the pin (not 0 or 255)
+const uint8_t TIMER1_PIN{16};    //!< Internal. Set pin is on TIMER1, needs special handling
+const uint8_t TEMPLATE_LED{32};  //!< Internal. Output and software PWM done by "smoothLEDT"
+const uint8_t OUTPUT_DUE{64};    //!< Internal. "smoothLEDT" has to set the output in this tick
+#ifdef SMOOTHLED_MODERN_AVR
+const uint8_t PORT_OUTSET{1};  //!< Internal. Offset of PORTn.OUTSET from PORTn.OUT
+const uint8_t PORT_OUTCLR{2};  //!< Internal. Offset of PORTn.OUTCLR from PORTn.OUT
+#endif
+/***************************************************************************************************
+** Binary stream protocol used by the "smoothLEDStream" class. Every frame is STREAM_FRAME_SIZE   **
+** bytes long and has the following layout (16-bit values are little-endian):                     **
+**   SYNC | COMMAND | INDEX | COUNT | LEVEL | SPEED LSB | SPEED MSB | DELAY LSB | DELAY MSB | CHK **
+** INDEX is the LED number in order of declaration (starting at 0) and COUNT is the number of     **
+** consecutive LEDs the command applies to, with 0 meaning all LEDs from INDEX onwards. CHK is    **
+** the XOR of all bytes between SYNC and CHK. XOFF is sent when the receive ring is full and XON  **
+** once there is room again; the sender must stop within one UART receive buffer after an XOFF.   **
+***************************************************************************************************/
+const uint8_t STREAM_SYNC{0xA5};          //!< First byte of every frame
+const uint8_t STREAM_FRAME_SIZE{10};      //!< Total bytes in a frame including SYNC and CHK
+const uint8_t STREAM_SET{0};              //!< COMMAND value to stack a "set()" command
+const uint8_t STREAM_SET_NOW{1};          //!< COMMAND value to perform a "setNow()" command
+const uint8_t STREAM_XON{0x11};           //!< Flow control, sender may resume sending
+const uint8_t STREAM_XOFF{0x13};          //!< Flow control, sender has to pause
+const uint8_t STREAM_RING_SIZE{8};        //!< Number of decoded frames buffered, power of 2
+/***************************************************************************************************
+** Each LED has a ring of SET_QUEUE_SIZE stacked "set()" commands of 6 Bytes each, which is part  **
+** of the instance so nothing is allocated at runtime. When the ring is full "set()" returns      **
+** false and the command is ignored. The size has to be a power of 2 from 1 to 128. It can be     **
+** changed here or with a compiler option such as "-DSET_QUEUE_SIZE=16", which has to be used for **
+** the library as well as the sketch since it changes the size of the class. Every command,       **
+** including an immediate "set(level)", is started by "faderISR()" in the next fader tick, so     **
+** "getLevel()" still returns the previous level and "isBusy()" returns true for up to 1ms after  **
+** the call.                                                                                      **
+***************************************************************************************************/
+#ifndef SET_QUEUE_SIZE
+#define SET_QUEUE_SIZE 8  //!< Stacked "set()" commands per LED, power of 2
+#endif
+static_assert(SET_QUEUE_SIZE >= 1 && SET_QUEUE_SIZE <= 128 &&
+                  (SET_QUEUE_SIZE & (SET_QUEUE_SIZE - 1)) == 0,
+              "SET_QUEUE_SIZE has to be a power of 2 from 1 to 128");
+/*! Define the ring buffer entry for stacking set() commands */
 struct setStructure {
-  uint8_t       targetLevel{0};  //!< next target level
-  uint16_t      changeSpeed{0};  //!< next change speed
-  uint16_t      delayMS{0};      //!< next wait time
-  setStructure* next{nullptr};   //!< next element in list
-};                               // of struct "setStructure"
+  uint8_t  targetLevel{0};   //!< next target level
+  uint8_t  fromLevel{0};     //!< level the fade rate was computed for
+  uint16_t changeDelays{0};  //!< next fade rate, 0 for immediate
+  uint16_t delayMS{0};       //!< next wait time
+};                           // of struct "setStructure"
+/***************************************************************************************************
+** Effects started with "setEffect()" are computed by "faderISR()" every "rate" milliseconds, so  **
+** the sketch doesn't need to call "set()" with new random values many times a second. The level  **
+** varies between "base" and "base + amplitude" (limited to 255). The random values come from a   **
+** 16-bit xorshift generator and all computations use 8x8 bit multiplications, so an update costs **
+** a fixed number of cycles regardless of the effect.                                             **
+**   EFFECT_CANDLE    flickers below the top level with mostly small and occasional deep dips     **
+**   EFFECT_STROBE    alternates between the base and the top level                               **
+**   EFFECT_NOISE     a new random level between the base and the top level in every update       **
+**   EFFECT_HEARTBEAT a double pulse every 16 updates, e.g. a rate of 50ms gives 75 beats/minute  **
+***************************************************************************************************/
+const uint8_t EFFECT_NONE{0};       //!< No effect, the LED follows "set()" and "setNow()"
+const uint8_t EFFECT_CANDLE{1};     //!< Candle flicker
+const uint8_t EFFECT_STROBE{2};     //!< Strobe between the base and the top level
+const uint8_t EFFECT_NOISE{3};      //!< Random levels
+const uint8_t EFFECT_HEARTBEAT{4};  //!< Heartbeat double pulse
+/*! Envelope of the heartbeat effect, 16 steps scaled by the amplitude */
+const PROGMEM uint8_t kheartbeat[] = {0, 90, 255, 110, 20, 120, 190, 80, 25, 5, 0, 0, 0, 0, 0, 0};
+/*! Define the generator descriptor of a running effect */
+struct effectStructure {
+  uint8_t type{EFFECT_NONE};  //!< EFFECT_xxx, only read by "faderISR()" when not EFFECT_NONE
+  uint8_t base{0};            //!< lowest level
+  uint8_t amplitude{0};       //!< level range above the base
+  uint8_t rate{1};            //!< milliseconds between updates
+  uint8_t ticker{0};          //!< milliseconds until the next update
+  uint8_t phase{0};           //!< position in the strobe or heartbeat cycle
+};                            // of struct "effectStructure"
+/***************************************************************************************************
+** A scene is a PROGMEM array with one level for every smoothLED instance, in order of            **
+** declaration and including the instances that haven't called "begin()", e.g. for three LEDs     **
+**   const PROGMEM uint8_t EVENING[] = {255, 40, 0};                                              **
+** Then "smoothLED::crossfadeTo(EVENING, 2000)" fades all LEDs from their current levels to the   **
+** scene in 2 seconds. The number of levels is taken from the array, a scene given as a pointer   **
+** needs the count as well, e.g. "crossfadeTo(scenes[i], 3, 2000)". LEDs beyond the end of the    **
+** scene keep their level, effect and stacked commands. "faderISR()" advances one shared progress **
+** value in each tick and interpolates each LED between its start and scene level with an 8x8 bit **
+** multiplication, so all LEDs arrive in the same tick and the cost per LED is constant. A        **
+** crossfade discards all stacked commands of its LEDs and stops their effects, commands stacked  **
+** afterwards fade from the scene level when it has finished. "setNow()" and "setEffect()" take   **
+** an LED out of a running crossfade.                                                             **
+***************************************************************************************************/
+const uint32_t SCENE_END{1UL << 24};  //!< Crossfade progress when complete, 1/2^24 steps
+/***************************************************************************************************
+** Other code can run lightweight callbacks off the fader interrupt, about every millisecond, by  **
+** registering them with "smoothLEDTick::attach()". Each callback has a divisor (1 means every    **
+** tick, 5 every fifth tick) and a budget in units of 64 CPU cycles (4us at 16MHz). The time of   **
+** each call is measured with the timer counter; a callback that takes longer than its budget is  **
+** detached so that it can't delay the software PWM and fading. The measurement is accurate to    **
+** +/-1 unit and only differences up to 255 units fit into 8 bits, so budgets are limited to      **
+** 1-254 units. The callbacks are called with interrupts disabled, so they must not use Serial,   **
+** delay() or wait for anything. The fader interrupt stays enabled while any callback is          **
+** attached.                                                                                      **
+***************************************************************************************************/
+const uint8_t TICK_CALLBACKS{4};     //!< Number of tick callbacks that can be attached
+const uint8_t TICK_BUDGET{8};        //!< Default budget, 8 * 64 = 512 CPU cycles
+const uint8_t TICK_BUDGET_MAX{254};  //!< Largest budget that the 8-bit measurement can check
+#ifdef FRAME_SYNC_ACTIVE
+const uint8_t SYNC_OFF{0};       //!< Default. Boards run independently
+const uint8_t SYNC_MASTER{1};    //!< Output a pulse at the start of every PWM frame
+const uint8_t SYNC_SLAVE{2};     //!< Lock the PWM frame and fader ticks to the pulses on a pin
+const uint8_t SYNC_PULSE{4};     //!< Pulse width in PWM steps of 1024 CPU cycles
+const uint8_t SYNC_MAX_STEP{8};  //!< Largest PWM frame correction per pulse in steps
+#endif
+template <bool Inverted, class CurvePolicy, class OutputPolicy>
+class smoothLEDT;  // LED with compile-time pin behaviour, see below
 class smoothLED {
   /*!
     @class   smoothLED
@@ -138,17 +355,92 @@ class smoothLED {
   smoothLED&  operator+(const int16_t& value);                      // addition overload
   smoothLED&  operator-(const int16_t& value);                      // subtraction overload
   bool        begin(const uint8_t pin, const uint8_t flags = 0);    // Initialize a pin for PWM
-  void        set(const uint8_t  val   = 0,                         // Set a pin's PWM value
+  bool        set(const uint8_t  val   = 0,                         // Set a pin's PWM value
                   const uint16_t speed = 0,                         // Change speed in ms, optional
                   const uint16_t delay = 0);                        // Delay after fade, optional
   void        setNow(const uint8_t  val   = 0,                      // Set PWM value and override
                      const uint16_t speed = 0,                      // Change speed in ms, optional
                      const uint16_t delay = 0);                     // Delay after fade, optional
+  uint8_t     getLevel() const;                                     // Current PWM level 0-255
+  bool        isBusy() const;                                       // Fade, wait or stack active
+  void        setMaxLevel(const uint8_t level = 255);               // Scale this LED's output
+  void        setEffect(const uint8_t effect    = EFFECT_NONE,      // Start or stop an effect
+                        const uint8_t base      = 0,                // Lowest level
+                        const uint8_t amplitude = 255,              // Range above the base
+                        const uint8_t rate      = 20);              // ms between updates
+#ifdef MASTER_BRIGHTNESS_ACTIVE
+  static void setMasterBrightness(const uint8_t level = 255);       // Scale all LEDs' output
+#endif
+  static void crossfadeTo(const uint8_t* scene,                     // Fade the first "count"
+                          const uint8_t  count,                     // LEDs to a scene
+                          const uint16_t ms);                       // in ms
+  template <uint8_t N>                                              // Fade the LEDs to a scene
+  static void crossfadeTo(const uint8_t (&scene)[N],                // of N levels
+                          const uint16_t ms = 0) {                  // in ms, optional
+    crossfadeTo(scene, N, ms);
+  }                                                                 // of "crossfadeTo()"
+#ifdef SMOOTHLED_TRACE
+  static void dumpTrace(Stream& port);                              // Write and clear the trace
+#endif
+#ifdef FRAME_SYNC_ACTIVE
+  static bool    setSync(const uint8_t mode = SYNC_OFF,             // Synchronize with boards
+                         const uint8_t pin  = 0);                   // on this pin
+  static int8_t  syncError();                                       // Last frame phase error
+  static void    syncISR();                                         // Function for sync pulses
+  static uint8_t syncTicks(const uint8_t ticks = 1);                // Corrected fader ticks
+#endif
+#ifdef SMOOTHLED_MODERN_AVR
+  static uint8_t faderTicks();                                      // 1ms ticks due from TCA0
+#endif
   static void pwmISR();                                             // Function for software PWM
   static void faderISR();                                           // Function for fading
+  friend class smoothLEDStream;                                     // Stream decoder uses list
+  friend class smoothLEDTick;                                       // Callbacks wake the fader
+  template <bool Inverted, class CurvePolicy, class OutputPolicy>  // Compile-time LEDs use
+  friend class smoothLEDT;                                          // the list and registers
  private:                                                           // declare private class
-  static smoothLED* _firstLink;                                     //!< Static ptr to 1st instance
-  static uint8_t    _counterPWM;                                    //!< Counter variable in ISR()
+  /*! Hot paths of all LEDs of one "smoothLEDT" type, the interrupts call them once per type */
+  struct ledGroup {
+    void (*pwmStep)();  //!< Software PWM step of the LEDs, nullptr for hardware PWM
+    bool (*output)();   //!< Sets the outputs marked OUTPUT_DUE, TRUE if software PWM is on
+    ledGroup* next;     //!< Next "smoothLEDT" type, nullptr at the end
+  };                    // of struct "ledGroup"
+  typedef volatile uint8_t* ioRegister;                             //!< Pointer to I/O register
+  static smoothLED*       _firstLink;                               //!< Static ptr to 1st instance
+  static ledGroup*        _firstGroup;                              //!< "smoothLEDT" types in use
+  static uint8_t          _counterPWM;                              //!< Counter variable in ISR()
+  static volatile uint8_t _sleepTicks;                              //!< faderISR() ticks to skip
+  static uint8_t          _skippedTicks;                            //!< Ticks skipped, ISR only
+  static volatile bool    _refreshAll;                              //!< Recompute all LED outputs
+  static uint16_t         _random;                                  //!< Effect xorshift state
+  static volatile bool    _sceneActive;                             //!< Crossfade is running
+  static volatile bool    _sceneStart;                              //!< Crossfade starts now
+  static uint32_t         _sceneStep;                               //!< Progress per tick
+  static uint32_t         _sceneProgress;                           //!< Up to SCENE_END, ISR only
+#ifdef SMOOTHLED_MODERN_AVR
+  static uint16_t         _faderStep;                               //!< TCA0 period, 16 cycles
+  static uint16_t         _faderPhase;                              //!< Cycles/16 to next tick
+#endif
+#ifdef SMOOTHLED_TRACE
+  static traceEntry _trace[TRACE_SIZE];                             //!< Ring buffer of events
+  static uint8_t    _traceHead;                                     //!< Next entry to write
+  static bool       _traceWrapped;                                  //!< All entries are in use
+#ifdef SMOOTHLED_MODERN_AVR
+  static uint16_t   _traceOverflows;                                //!< TCA0 periods, timestamps
+#endif
+#endif
+#ifdef FRAME_SYNC_ACTIVE
+  static uint8_t    _syncMode;                                      //!< SYNC_OFF, MASTER or SLAVE
+  static uint8_t    _syncPin;                                       //!< Pin of the sync pulses
+  static ioRegister _syncPort;                                      //!< Master output PORT{n}
+  static uint8_t    _syncMask;                                      //!< Master output bit mask
+  static uint8_t    _syncTicks;                                     //!< Fader ticks since a pulse
+  static int16_t    _syncPhase;                                     //!< Ticks behind master*256
+  static int8_t     _syncError;                                     //!< Last frame phase error
+#endif
+#ifdef MASTER_BRIGHTNESS_ACTIVE
+  static uint8_t    _masterLevel;                                   //!< Master brightness 0-255
+#endif
   smoothLED*        _nextLink{nullptr};                             //!< Ptr to the next instance
   volatile uint8_t  _flags{0};                                      //!< Status bits, see cpp file
   volatile uint8_t* _portRegister{nullptr};                         //!< Pointer to PORT{n} Register
@@ -158,12 +450,291 @@ class smoothLED {
   volatile uint8_t  _currentLevel{0};                               //!< Current PWM level 0-255
   volatile uint8_t  _currentCIE{0};                                 //!< PWM level from cie table
   volatile uint16_t _waitTime{0};                                   //!< Time to wait after fade
-  uint8_t           _targetLevel{0};                                //!< Target PWM level 0-255
-  uint16_t          _changeDelays{0};                               //!< Delay milliseconds in fades
-  volatile int16_t  _changeTicker{0};                               //!< Countdown timer for fading
-  setStructure*     _nextSet{nullptr};                              //!< Next "set()" command to run
+  volatile uint8_t  _targetLevel{0};                                //!< Target PWM level 0-255
+  uint16_t          _changeDelays{128};                             //!< Ticks*128 per fade step
+  volatile uint16_t _changeTicker{0};                               //!< Countdown timer for fading
+  setStructure      _queue[SET_QUEUE_SIZE];                         //!< Ring of stacked "set()"s
+  volatile uint8_t  _queueHead{0};                                  //!< Next to run, ISR only
+  volatile uint8_t  _queueTail{0};                                  //!< Next free, set() only
+  volatile uint8_t  _cancelIndex{0};                                //!< Ring index of "setNow()"
+  volatile uint8_t  _cancelGeneration{0};                           //!< Incremented by "setNow()"
+  uint8_t           _seenGeneration{0};                             //!< Last generation handled
+  uint8_t           _maxLevel{255};                                 //!< Output scale, 255 is 100%
+  effectStructure   _effect;                                        //!< Running effect, if any
+  volatile bool     _inScene{false};                                //!< Follows the crossfade
+  uint8_t           _sceneFrom{0};                                  //!< Level at crossfade start
+  uint8_t           _sceneTo{0};                                    //!< Level of the scene
   void              switchHardwarePWM(const bool state);            // Turn HW PWM on or off
+  void              startFade(const uint8_t  val,                   // Start a new action from
+                              const uint16_t delays,                // inside "faderISR()"
+                              const uint16_t delay);                // Delay after fade
+  static uint16_t   fadeDelays(const uint8_t  from,                 // Compute fade rate
+                               const uint8_t  to,                   // for given level change
+                               const uint16_t speed);               // and speed
+  static uint16_t   rescaleDelays(const uint16_t delays,            // Adapt a fade rate
+                                  const uint8_t  from,              // computed for this level
+                                  const uint8_t  level,             // to the actual start level
+                                  const uint8_t  to);               // for the same fade time
+  void              releaseLevel();                                 // End effect and crossfade
+  void              updateOutput();                                 // Set CIE value and pin
+  uint8_t           scaledLevel() const;                            // Level after scaling
+  void              runEffect(const uint8_t skipped);               // Update a running effect
+  void              runScene(const uint16_t mix);                   // Interpolate crossfade
+#ifdef SMOOTHLED_TRACE
+  static void       trace(const uint8_t event,                      // Write an event to
+                          const uint8_t value);                     // the ring buffer
+  uint8_t           ledNumber() const;                              // Position in linked list
+#endif
   inline void       pinOn() const __attribute__((always_inline));   // Turn LED on
   inline void       pinOff() const __attribute__((always_inline));  // Turn LED off
 };                                                                  // of class definition
+/***************************************************************************************************
+** The flags given to "begin()" never change afterwards, but "pwmISR()" and "faderISR()" test     **
+** them for every LED in every step. The "smoothLEDT" template fixes the inversion, the           **
+** brightness curve and the PWM type at compile time, e.g.                                        **
+**   smoothLEDT<true, cieCurve, softwarePWM> led;  // inverted, CIE curve, software PWM           **
+** Its instances are in the same list as the "smoothLED" instances for fading and all of the      **
+** other functions, but the runtime code skips their outputs. Each template type keeps its own    **
+** list, and the interrupts call the PWM step and output function of each type in use once, which **
+** then handle all LEDs of that type without testing the inversion, curve or PWM type and without **
+** an indirect call per LED. The pin is still given in "begin()", as the Arduino pin to port      **
+** mapping is only known at runtime. Each instance needs 2 more Bytes of RAM for the list of its  **
+** type.                                                                                          **
+***************************************************************************************************/
+#ifdef CIE_MODE_ACTIVE
+/*! @brief Curve policy, look the PWM value up in the "kcie" table */
+struct cieCurve {
+  static const uint8_t flags{CIE_MODE};  //!< Equivalent "begin()" flag
+  static inline uint8_t apply(const uint8_t level) { return pgm_read_byte(kcie + level); }  //!< PWM
+};                                       // of struct "cieCurve"
+#endif
+/*! @brief Curve policy, use the level directly as the PWM value */
+struct linearCurve {
+  static const uint8_t flags{NO_CIE_MODE};                             //!< Equivalent flag
+  static inline uint8_t apply(const uint8_t level) { return level; }  //!< PWM value of a level
+};                                                                     // of struct "linearCurve"
+/*! @brief Output policy, the PWM is done by "pwmISR()" on any pin */
+struct softwarePWM {
+  static const uint8_t flags{SOFTWARE_MODE};  //!< Equivalent "begin()" flag
+  static const bool    software{true};        //!< PWM is done in software
+};                                            // of struct "softwarePWM"
+/*! @brief Output policy, the PWM is done by the timer hardware, the pin has to support it */
+struct hardwarePWM {
+  static const uint8_t flags{HARDWARE_MODE};  //!< Equivalent "begin()" flag
+  static const bool    software{false};       //!< PWM is done by the timer
+};                                            // of struct "hardwarePWM"
+#ifdef CIE_MODE_ACTIVE
+template <bool Inverted = false, class CurvePolicy = cieCurve, class OutputPolicy = hardwarePWM>
+#else
+template <bool Inverted = false, class CurvePolicy = linearCurve, class OutputPolicy = hardwarePWM>
+#endif
+class smoothLEDT : public smoothLED {
+  /*!
+    @class   smoothLEDT
+    @brief   smoothLED with inversion, brightness curve and PWM type fixed at compile time
+  */
+ public:  // Declare visible members
+  ~smoothLEDT() {
+    /*!
+      @brief   Class destructor
+      @details Removes the instance from the list of its type, the base class destructor then
+               removes it from the list of all LEDs
+    */
+    unlink();
+  }  // of class destructor
+  bool begin(const uint8_t pin) {
+    /*!
+      @brief     Initializes the LED
+      @details   The LED is initialized by "smoothLED::begin()" with the flags equivalent to the
+                 template parameters and then added to the list of its type, whose functions are
+                 added to the interrupts when the first LED of the type is initialized
+      @param[in] pin  The Arduino pin number of the LED
+      @return    bool TRUE on success, FALSE when the pin is in use or the hardwarePWM policy is
+                 used on a pin without hardware PWM
+    */
+    if (!smoothLED::begin(pin, (Inverted ? INVERT_LED : NO_INVERT_LED) | CurvePolicy::flags |
+                                   OutputPolicy::flags)) {
+      unlink();     // the pin is in use
+      return false;
+    }               // if-then begin failed
+    uint8_t originalSREG = SREG;  // Save original SREG value
+    cli();                        // disable interrupts while changing the lists
+    if (!OutputPolicy::software && (_flags & SOFTWARE_MODE)) {  // pin has no hardware PWM
+      _portRegister = nullptr;                                  // so disable the LED
+      SREG          = originalSREG;                             // Restore registers
+      unlink();                                                 // and remove it
+      return false;                                             // return error
+    }                                                           // if-then no hardware PWM
+    _flags |= TEMPLATE_LED;  // the runtime code skips the output
+    smoothLEDT* p = _firstOfType;
+    while (p != nullptr && p != this) p = p->_nextOfType;  // search the list of the type
+    if (p == nullptr) {                                     // add the LED if it isn't in it
+      _nextOfType  = _firstOfType;
+      _firstOfType = this;
+    }                                                       // if-then add the LED
+    smoothLED::ledGroup* g = _firstGroup;
+    while (g != nullptr && g != &_group) g = g->next;      // search the types in use
+    if (g == nullptr) {                                     // add the type if it isn't in use
+      _group.next = _firstGroup;
+      _firstGroup = &_group;
+    }                             // if-then add the type
+    _refreshAll = true;           // output is set by the type in the next tick
+    SREG        = originalSREG;   // Restore registers
+    return true;                  // Return success
+  }                               // of function "begin()"
+
+ private:                                  // declare private class
+  smoothLEDT*                _nextOfType{nullptr};  //!< Next LED of this type
+  static smoothLEDT*         _firstOfType;          //!< First LED of this type
+  static smoothLED::ledGroup _group;                //!< Functions of this type for the interrupts
+  void unlink() {
+    /*! @brief Removes the LED from the list of its type */
+    uint8_t originalSREG = SREG;  // Save original SREG value
+    cli();                        // disable interrupts while changing the list
+    smoothLEDT** link = &_firstOfType;
+    while (*link != nullptr && *link != this) link = &(*link)->_nextOfType;
+    if (*link == this) *link = _nextOfType;  // remove it when found
+    _nextOfType = nullptr;
+    SREG        = originalSREG;  // Restore interrupt state to original
+  }                              // of function "unlink()"
+  static inline void pinOn(const smoothLEDT* p) __attribute__((always_inline)) {
+    /*! @brief Turn the LED on, the polarity is resolved at compile time */
+#ifdef SMOOTHLED_MODERN_AVR
+    *(p->_portRegister + (Inverted ? PORT_OUTCLR : PORT_OUTSET)) = p->_registerBitMask;
+#else
+    if (Inverted) {
+      *p->_portRegister &= ~p->_registerBitMask;
+    } else {
+      *p->_portRegister |= p->_registerBitMask;
+    }  // if-then-else inverted
+#endif
+  }  // of function "pinOn()"
+  static inline void pinOff(const smoothLEDT* p) __attribute__((always_inline)) {
+    /*! @brief Turn the LED off, the polarity is resolved at compile time */
+#ifdef SMOOTHLED_MODERN_AVR
+    *(p->_portRegister + (Inverted ? PORT_OUTSET : PORT_OUTCLR)) = p->_registerBitMask;
+#else
+    if (Inverted) {
+      *p->_portRegister |= p->_registerBitMask;
+    } else {
+      *p->_portRegister &= ~p->_registerBitMask;
+    }  // if-then-else inverted
+#endif
+  }  // of function "pinOff()"
+  static void pwmStep() {
+    /*! @brief Software PWM step of all LEDs of this type, called from "pwmISR()" */
+    const uint8_t counter = _counterPWM;  // step in the PWM frame
+    for (smoothLEDT* p = _firstOfType; p != nullptr; p = p->_nextOfType) {
+      if (p->_currentCIE == counter) {  // If we've reached the PWM counter threshold
+        pinOff(p);                      // then turn pin off
+      } else if (counter == 0) {        // if we've rolled over and are at the beginning,
+        pinOn(p);                       // turn the pin on
+      }                                 // if-then-else turn off LED
+    }                                   // for-next each LED of the type
+  }                                     // of function "pwmStep()"
+  static bool output() {
+    /*!
+      @brief   Sets the curve value and the pin or PWM register, called from "faderISR()"
+      @details Only the LEDs of this type marked with OUTPUT_DUE by "faderISR()" are updated
+      @return  bool TRUE when a software PWM LED of this type has PWM active
+    */
+    bool pwm{false};  // set when software PWM is needed
+    for (smoothLEDT* p = _firstOfType; p != nullptr; p = p->_nextOfType) {
+      if (p->_flags & OUTPUT_DUE) {               // If the level has changed
+        p->_flags &= ~OUTPUT_DUE;                 // then only update it once
+        uint8_t level  = p->scaledLevel();        // level after the scales
+        p->_currentCIE = CurvePolicy::apply(level);
+        if (level == 0 || level == 255) {         // if value is OFF or ON
+          p->_flags &= ~PWM_ACTIVE;               // turn off PWM flag
+          if (!OutputPolicy::software) p->switchHardwarePWM(false);
+          if (level == 0) {
+            pinOff(p);
+          } else {
+            pinOn(p);
+          }  // if-then turn "OFF" or "ON"
+        } else {
+          p->_flags |= PWM_ACTIVE;  // turn on PWM flag
+          if (!OutputPolicy::software) {
+            p->switchHardwarePWM(true);  // turn on PWM mode
+            uint8_t value = Inverted ? 255 - p->_currentCIE : p->_currentCIE;
+            if (p->_flags & TIMER1_PIN) {  // TIMER1 pins are 10 bit and re-casting and shifting
+              *(volatile uint16_t*)p->_PWMRegister = (uint16_t)value << 2;
+            } else {
+              *p->_PWMRegister = value;
+            }  // if-then-else TIMER1 pin
+          }    // if-then hardware PWM
+        }      // if-then-else "ON" or "OFF"
+      }        // if-then output due
+      if (OutputPolicy::software && (p->_flags & PWM_ACTIVE)) pwm = true;
+    }  // for-next each LED of the type
+    return pwm;
+  }  // of function "output()"
+};   // of class definition
+/*! First LED of a "smoothLEDT" type, one list per type */
+template <bool Inverted, class CurvePolicy, class OutputPolicy>
+smoothLEDT<Inverted, CurvePolicy, OutputPolicy>*
+    smoothLEDT<Inverted, CurvePolicy, OutputPolicy>::_firstOfType{nullptr};
+/*! Functions of a "smoothLEDT" type for the interrupts */
+template <bool Inverted, class CurvePolicy, class OutputPolicy>
+smoothLED::ledGroup smoothLEDT<Inverted, CurvePolicy, OutputPolicy>::_group{
+    OutputPolicy::software ? &smoothLEDT<Inverted, CurvePolicy, OutputPolicy>::pwmStep : nullptr,
+    &smoothLEDT<Inverted, CurvePolicy, OutputPolicy>::output, nullptr};
+class smoothLEDStream {
+  /*!
+    @class   smoothLEDStream
+    @brief   Decodes the compact binary frame protocol from a Stream and drives smoothLED instances
+  */
+ public:                                                   // Declare visible members
+  explicit smoothLEDStream(Stream& port);                  // Class constructor
+  smoothLEDStream(const smoothLEDStream&) = delete;        // disable copy constructor
+  void     poll();                                         // Decode and dispatch pending frames
+  uint8_t  pending() const;                                // Number of decoded, undispatched frames
+  uint16_t errors() const;                                 // Number of frames with bad checksums
+ private:                                                  // declare private class
+  /*! Decoded frame as stored in the receive ring */
+  struct streamCommand {                                   // Decoded frame contents
+    uint8_t  command{0};                                   //!< STREAM_SET or STREAM_SET_NOW
+    uint8_t  index{0};                                     //!< First LED index
+    uint8_t  count{0};                                     //!< Number of LEDs, 0 for all
+    uint8_t  level{0};                                     //!< Target level 0-255
+    uint16_t speed{0};                                     //!< Change speed in ms
+    uint16_t delay{0};                                     //!< Delay after fade in ms
+  };                                                       // of struct "streamCommand"
+  Stream&       _port;                                     //!< Serial port to read frames from
+  uint8_t       _frame[STREAM_FRAME_SIZE]{0};              //!< Partially received frame
+  uint8_t       _framePos{0};                              //!< Number of bytes in "_frame"
+  streamCommand _ring[STREAM_RING_SIZE];                   //!< Decoded frames awaiting dispatch
+  uint8_t       _ringHead{0};                              //!< Index of next frame to dispatch
+  uint8_t       _ringTail{0};                              //!< Index of next free ring entry
+  bool          _paused{false};                            //!< Set while sender has been sent XOFF
+  uint16_t      _errors{0};                                //!< Count of discarded frames
+  bool          dispatch(const streamCommand& cmd) const;  // Apply a frame to the LEDs
+};                                                         // of class definition
+class smoothLEDTick {
+  /*!
+    @class   smoothLEDTick
+    @brief   Table of callbacks that are called from the fader interrupt about every millisecond
+  */
+ public:                                                       // Declare visible members
+  static bool    attach(void (*callback)(),                    // Call a function from the
+                        const uint8_t divisor = 1,             // fader interrupt every n ticks,
+                        const uint8_t budget  = TICK_BUDGET);  // cost limit in 64 cycle units
+  static void    detach(void (*callback)());                   // Stop calling a function
+  static uint8_t cost(void (*callback)());                     // Worst cost in 64 cycle units
+  static uint8_t overruns();                                   // Callbacks detached over budget
+  static void    tickISR();                                    // Function for the callbacks
+  friend class smoothLED;                                      // "faderISR()" checks "_clients"
+ private:                                                      // declare private class
+  /*! Table entry of an attached callback */
+  struct tickEntry {                                           // Callback and its counters
+    void (*callback)(){nullptr};                               //!< Function, nullptr if entry free
+    uint8_t divisor{1};                                        //!< Call in every "divisor" ticks
+    uint8_t counter{1};                                        //!< Ticks until the next call
+    uint8_t budget{TICK_BUDGET};                               //!< Allowed cost, 1-254 units
+    uint8_t worst{0};                                          //!< Largest measured cost
+  };                                                           // of struct "tickEntry"
+  static tickEntry _table[TICK_CALLBACKS];                     //!< Attached callbacks
+  static uint8_t   _clients;                                   //!< Number of attached callbacks
+  static uint8_t   _overruns;                                  //!< Callbacks detached over budget
+};                                                             // of class definition
 #endif